@@ -0,0 +1,45 @@
+#!/bin/bash
+# Compares the csma and p2p link models on one topology: iperf3 goodput in
+# both directions of every link (through the container stand-in) and the
+# emulator's executed events per second.
+#
+# usage: sudo ./script/bench/link_mode.sh [experiment_name] [duration_s]
+
+EXPERIMENT_NAME=${1:-newyork}
+DURATION=${2:-30}
+ROOT_DIR="$(pwd)"
+CONFIG="$ROOT_DIR/script/topology/$EXPERIMENT_NAME/NETWORK_CONFIG.json5"
+OUT_DIR="bench_output/link_mode/$EXPERIMENT_NAME"
+STANDIN="python3 script/bench/standin.py"
+WAIT_READY="python3 script/tools/wait_ready.py -q --timeout 60"
+
+if [ ! -f "$CONFIG" ]; then
+    echo "ERROR: $CONFIG not found"
+    exit 1
+fi
+mkdir -p "$OUT_DIR"
+
+$STANDIN down "$CONFIG"
+$STANDIN up "$CONFIG" || exit 1
+
+for MODE in csma p2p; do
+    echo "=== $MODE ==="
+    (cd ns-3-dev && ./ns3 run "zenoh --config=$CONFIG --linkType=$MODE --stopTime=$((DURATION + 10)) \
+        --outputDir=$ROOT_DIR/$OUT_DIR/ns3_$MODE" --no-build) > "$OUT_DIR/ns3_$MODE.log" 2>&1 &
+    NS3_PID=$!
+    $WAIT_READY "$ROOT_DIR/$OUT_DIR/ns3_$MODE/ready.json"
+    $STANDIN iperf "$CONFIG" --bidir --duration "$DURATION" > "$OUT_DIR/iperf_$MODE.json"
+    wait $NS3_PID
+
+    python3 - "$OUT_DIR/iperf_$MODE.json" <<'PY'
+import json, sys
+rows = [r for r in json.load(open(sys.argv[1])) if "error" not in r]
+util = [(r["ab_mbps"] + r["ba_mbps"]) / 2 / r["cap_mbps"] for r in rows]
+print("links measured: %d" % len(rows))
+print("goodput per direction / cap: mean %.1f%%  min %.1f%%" %
+      (100 * sum(util) / max(len(util), 1), 100 * min(util, default=0)))
+PY
+    grep -E "run summary|^lag:" "$OUT_DIR/ns3_$MODE.log"
+done
+
+$STANDIN down "$CONFIG"
@@ -0,0 +1,38 @@
+#!/bin/bash
+# Replays a TAP trace recorded with --tapTrace twice, with the link
+# observers on, and fails unless the replay delivers latency samples and
+# both runs give the same samples. Needs no TAPs, containers or root.
+#
+# usage: ./script/bench/replay_check.sh <experiment_name> <tap_trace.bin>
+#   e.g. ./script/bench/replay_check.sh twopath ns3_output/twopath/<run>/tap_trace.bin
+
+EXPERIMENT_NAME=$1
+TRACE=$(realpath "$2" 2>/dev/null)
+ROOT_DIR="$(pwd)"
+CONFIG="$ROOT_DIR/script/topology/$EXPERIMENT_NAME/NETWORK_CONFIG.json5"
+OUT_DIR="$ROOT_DIR/bench_output/replay_check/$EXPERIMENT_NAME"
+
+if [ ! -f "$CONFIG" ] || [ ! -f "$TRACE" ]; then
+    echo "usage: $0 <experiment_name> <tap_trace.bin>"
+    exit 1
+fi
+mkdir -p "$OUT_DIR"
+
+for RUN in 1 2; do
+    rm -rf "$OUT_DIR/run_$RUN"
+    (cd ns-3-dev && ./ns3 run "zenoh --config=$CONFIG --mode=replay --replay=$TRACE --latency \
+        --telemetryInterval=10 --outputDir=$OUT_DIR/run_$RUN" --no-build) \
+        > "$OUT_DIR/run_$RUN.log" 2>&1 || { echo "FAIL: run $RUN, see $OUT_DIR/run_$RUN.log"; exit 1; }
+    grep "^replay" "$OUT_DIR/run_$RUN.log"
+done
+
+SAMPLES=$(($(wc -l < "$OUT_DIR/run_1/latency_samples.csv") - 1))
+if [ "$SAMPLES" -le 0 ]; then
+    echo "FAIL: no latency samples in replay"
+    exit 1
+fi
+if ! cmp -s "$OUT_DIR/run_1/latency_samples.csv" "$OUT_DIR/run_2/latency_samples.csv"; then
+    echo "FAIL: two replays of the same trace gave different latency samples"
+    exit 1
+fi
+echo "OK: $SAMPLES latency samples, identical in both replays"
@@ -0,0 +1,73 @@
+#!/bin/bash
+# Aggregate frame rate and real-time lag of the emulator as the number of
+# shards grows. Every link is rewritten to CAP_MBPS and loaded with a UDP
+# stream of small datagrams through the container stand-in.
+#
+# usage: sudo ./script/bench/shard_scaling.sh [experiment] [duration_s] [cap_mbps] [shard counts...]
+#   e.g. sudo ./script/bench/shard_scaling.sh newyork 30 100 1 2 4 8
+
+EXPERIMENT_NAME=${1:-newyork}
+DURATION=${2:-30}
+CAP_MBPS=${3:-100}
+shift $(( $# < 3 ? $# : 3 ))
+SHARD_COUNTS=${*:-1 2 4 8}
+
+ROOT_DIR="$(pwd)"
+SRC_CONFIG="$ROOT_DIR/script/topology/$EXPERIMENT_NAME/NETWORK_CONFIG.json5"
+OUT_DIR="$ROOT_DIR/bench_output/shard_scaling/$EXPERIMENT_NAME"
+CONFIG="$OUT_DIR/NETWORK_CONFIG.json5"
+STANDIN="python3 script/bench/standin.py"
+WAIT_READY="python3 script/tools/wait_ready.py -q --timeout 60"
+
+if [ ! -f "$SRC_CONFIG" ]; then
+    echo "ERROR: $SRC_CONFIG not found"
+    exit 1
+fi
+mkdir -p "$OUT_DIR"
+
+python3 - "$SRC_CONFIG" "$CONFIG" "$CAP_MBPS" <<'PY'
+import json, json5, sys
+cfg = json5.load(open(sys.argv[1]))
+for link in cfg["links"]:
+    link["cap"] = float(sys.argv[3])
+json.dump(cfg, open(sys.argv[2], "w"), indent=1)
+PY
+
+$STANDIN down "$CONFIG"
+$STANDIN up "$CONFIG" || exit 1
+
+# Offer ~80% of every link with 200-byte datagrams.
+RATE="$(python3 -c "print('%dK' % ($CAP_MBPS * 800))")"
+
+printf "%-7s %12s %10s %10s %10s\n" shards frames_per_s lost_pct lag_p99_us lag_max_us
+for N in $SHARD_COUNTS; do
+    RUN_DIR="$OUT_DIR/shards_$N"
+    rm -rf "$RUN_DIR"
+    (cd ns-3-dev && ./ns3 run "zenoh --config=$CONFIG --shards=$N --stopTime=$((DURATION + 10)) \
+        --outputDir=$RUN_DIR --readyFile=$RUN_DIR/ready.json" --no-build) \
+        > "$OUT_DIR/ns3_$N.log" 2>&1 &
+    NS3_PID=$!
+    if [ "$N" -gt 1 ]; then
+        $WAIT_READY "$RUN_DIR/ready.json" --shards "$N"
+    else
+        $WAIT_READY "$RUN_DIR/ready.json"
+    fi
+    $STANDIN iperf "$CONFIG" --udp "$RATE" --length 200 --duration "$DURATION" > "$OUT_DIR/iperf_$N.json"
+    wait $NS3_PID
+
+    python3 - "$OUT_DIR/iperf_$N.json" "$RUN_DIR" "$N" "$DURATION" <<'PY'
+import glob, json, sys
+rows = [r for r in json.load(open(sys.argv[1])) if "error" not in r]
+duration = float(sys.argv[4])
+received = sum(r["packets"] * (1 - r["lost_pct"] / 100) for r in rows)
+sent = sum(r["packets"] for r in rows)
+lost = 100 * (1 - received / sent) if sent else 0
+p99 = mx = 0
+for path in glob.glob(sys.argv[2] + "/**/lag_summary.json", recursive=True):
+    total = json.load(open(path))["total"]
+    p99, mx = max(p99, total["p99_us"]), max(mx, total["max_us"])
+print("%-7s %12.0f %10.2f %10.0f %10.0f" % (sys.argv[3], received / duration, lost, p99, mx))
+PY
+done
+
+$STANDIN down "$CONFIG"
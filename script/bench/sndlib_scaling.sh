@@ -0,0 +1,130 @@
+#!/bin/bash
+# How far one emulator process scales on SNDlib graphs, without containers.
+# Each graph is imported with sndlib_import.py (every link at CAP_MBPS) and
+# its links are loaded with UDP datagrams through the container stand-in.
+# A step passes when the lag monitor does not flag the run (--lagThreshold).
+#
+#   1. links: each loaded link carries PPS packets/s and the number of loaded
+#      links doubles until a step is flagged or every link is loaded.
+#   2. rate: every link is loaded and the per-link rate doubles from PPS
+#      until a step is flagged or the offered load reaches 90% of the cap.
+#
+# Per graph it reports the largest loaded link count and the highest
+# aggregate delivered packets/s that ran without lag, in summary.csv.
+#
+# usage: sudo ./script/bench/sndlib_scaling.sh [-d seconds] [-c cap_mbps] [-p pps]
+#            [-s bytes] [-l lag_ms] <sndlib network files...>
+#   e.g. sudo ./script/bench/sndlib_scaling.sh -d 20 germany50.xml ta2.txt
+
+DURATION=20
+CAP_MBPS=1000
+PPS=500
+LENGTH=200
+LAG_MS=10
+while getopts "d:c:p:s:l:" opt; do
+    case $opt in
+        d) DURATION=$OPTARG ;;
+        c) CAP_MBPS=$OPTARG ;;
+        p) PPS=$OPTARG ;;
+        s) LENGTH=$OPTARG ;;
+        l) LAG_MS=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+if [ $# -eq 0 ]; then
+    echo "usage: $0 [-d seconds] [-c cap_mbps] [-p pps] [-s bytes] [-l lag_ms] <sndlib files...>"
+    exit 1
+fi
+
+ROOT_DIR="$(pwd)"
+OUT_DIR="$ROOT_DIR/bench_output/sndlib_scaling"
+STANDIN="python3 script/bench/standin.py"
+WAIT_READY="python3 script/tools/wait_ready.py -q --timeout 60"
+mkdir -p "$OUT_DIR"
+SUMMARY="$OUT_DIR/summary.csv"
+echo "graph,nodes,links,max_links,pps_at_max_links,max_pps_per_link,max_agg_pps,lag_p99_us" > "$SUMMARY"
+
+# run_step <config> <run_dir> <links or ""> <pps per link>
+# prints: delivered_pps lag_p99_us flagged
+run_step() {
+    local config=$1 run_dir=$2 links=$3 pps=$4
+    rm -rf "$run_dir"
+    (cd ns-3-dev && ./ns3 run "zenoh --config=$config --stopTime=$((DURATION + 10)) \
+        --lagThreshold=$LAG_MS --scenario=none --outputDir=$run_dir" --no-build) \
+        > "$run_dir.log" 2>&1 &
+    local ns3_pid=$!
+    $WAIT_READY "$run_dir/ready.json"
+    $STANDIN iperf "$config" --udp "$((pps * LENGTH * 8 / 1000))K" --length "$LENGTH" \
+        --duration "$DURATION" --links "$links" > "$run_dir.iperf.json"
+    wait $ns3_pid
+
+    python3 - "$run_dir.iperf.json" "$run_dir/lag_summary.json" "$DURATION" <<'PY'
+import json, sys
+try:
+    rows = [r for r in json.load(open(sys.argv[1])) if "error" not in r]
+except ValueError:
+    rows = []
+received = sum(r["packets"] * (1 - r["lost_pct"] / 100) for r in rows)
+try:
+    lag = json.load(open(sys.argv[2]))
+    flagged, p99 = lag["flagged"], lag["total"]["p99_us"]
+except (OSError, ValueError, KeyError):
+    flagged, p99 = True, -1  # the emulator did not finish
+print("%.0f %.0f %d" % (received / float(sys.argv[3]), p99, flagged))
+PY
+}
+
+for SRC in "$@"; do
+    GRAPH="$(basename "${SRC%.*}")"
+    GRAPH_DIR="$OUT_DIR/$GRAPH"
+    CONFIG="$GRAPH_DIR/NETWORK_CONFIG.json5"
+    mkdir -p "$GRAPH_DIR"
+    python3 script/tools/sndlib_import.py "$SRC" --name "$GRAPH" --output "$CONFIG" \
+        --cap "$CAP_MBPS" --client-cap "$CAP_MBPS" || exit 1
+    NODES=$(grep -c 'zid:' "$CONFIG")
+    LINKS=$(grep -c '^ *{ a:' "$CONFIG")
+
+    $STANDIN down "$CONFIG"
+    $STANDIN up "$CONFIG" || exit 1
+    echo "=== $GRAPH: $NODES nodes, $LINKS links ==="
+
+    # 1. loaded links at a fixed rate per link
+    MAX_LINKS=0
+    PPS_AT_MAX=0
+    K=1
+    while :; do
+        [ "$K" -gt "$LINKS" ] && K=$LINKS
+        SELECTED="$(seq -s, -f 'L%g' 1 "$K")"
+        read -r DELIVERED P99 FLAGGED < <(run_step "$CONFIG" "$GRAPH_DIR/links_$K" "$SELECTED" "$PPS")
+        printf "links %5d  pps/link %7d  delivered_pps %9s  lag_p99_us %7s  %s\n" \
+            "$K" "$PPS" "$DELIVERED" "$P99" "$([ "$FLAGGED" = 1 ] && echo FLAGGED)"
+        [ "$FLAGGED" = 1 ] && break
+        MAX_LINKS=$K
+        PPS_AT_MAX=$DELIVERED
+        [ "$K" -eq "$LINKS" ] && break
+        K=$((K * 2))
+    done
+
+    # 2. rate per link with every link loaded
+    MAX_RATE=0
+    MAX_AGG=0
+    LAST_P99=-1
+    RATE=$PPS
+    while [ $((RATE * LENGTH * 8)) -le $((CAP_MBPS * 900000)) ]; do
+        read -r DELIVERED P99 FLAGGED < <(run_step "$CONFIG" "$GRAPH_DIR/rate_$RATE" "" "$RATE")
+        printf "links %5d  pps/link %7d  delivered_pps %9s  lag_p99_us %7s  %s\n" \
+            "$LINKS" "$RATE" "$DELIVERED" "$P99" "$([ "$FLAGGED" = 1 ] && echo FLAGGED)"
+        [ "$FLAGGED" = 1 ] && break
+        MAX_RATE=$RATE
+        MAX_AGG=$DELIVERED
+        LAST_P99=$P99
+        RATE=$((RATE * 2))
+    done
+
+    $STANDIN down "$CONFIG"
+    echo "$GRAPH,$NODES,$LINKS,$MAX_LINKS,$PPS_AT_MAX,$MAX_RATE,$MAX_AGG,$LAST_P99" >> "$SUMMARY"
+done
+
+echo
+column -s, -t "$SUMMARY"
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Container-free stand-in for the Zenoh nodes of an experiment.
+
+For every link end in NETWORK_CONFIG.json5 this creates the same TAP the
+launcher would (tap_<node>_<idx>), bridges it to a veth whose other end lives
+in a per-node network namespace with the endpoint's IP address. The ns-3
+emulator can then run unchanged and traffic can be pushed through its links
+with iperf3 instead of zenohd.
+
+    sudo standin.py up     <NETWORK_CONFIG.json5>
+    sudo standin.py iperf  <NETWORK_CONFIG.json5> [--duration S] [--bidir] ...
+    sudo standin.py down   <NETWORK_CONFIG.json5>
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+import time
+
+import json5
+
+
+def sh(cmd, check=True):
+    return subprocess.run(cmd, shell=True, check=check,
+                          stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+
+
+def load_links(path):
+    with open(path) as f:
+        cfg = json5.load(f)
+    nodes = cfg["nodes"]
+    links = []
+    for i, link in enumerate(cfg["links"]):
+        ends = []
+        for side in ("a", "b"):
+            node = str(link[side])
+            idx = int(link[side + "_idx"])
+            endpoint = nodes[node]["listen_endpoints"][idx]
+            ip = endpoint.split("/")[1].split(":")[0]
+            ends.append({"node": node, "idx": idx, "ip": ip,
+                         "tap": "tap_%s_%d" % (node, idx),
+                         "suffix": "%s_%d" % (node, idx)})
+        links.append({"name": "L%d" % (i + 1), "cap": link["cap"], "ends": ends})
+    return links
+
+
+def netns(node):
+    return "zs_" + node
+
+
+def up(links):
+    for node in sorted({e["node"] for l in links for e in l["ends"]}):
+        sh("ip netns add %s" % netns(node), check=False)
+        sh("ip netns exec %s ip link set lo up" % netns(node))
+    for link in links:
+        for e in link["ends"]:
+            s = e["suffix"]
+            sh("ip tuntap add dev %s mode tap" % e["tap"])
+            sh("ip link add zbr_%s type bridge" % s)
+            sh("ip link add zv_%s type veth peer name zp_%s" % (s, s))
+            sh("ip link set zp_%s netns %s" % (s, netns(e["node"])))
+            sh("ip link set %s master zbr_%s" % (e["tap"], s))
+            sh("ip link set zv_%s master zbr_%s" % (s, s))
+            for dev in (e["tap"], "zv_" + s, "zbr_" + s):
+                sh("ip link set %s promisc on up" % dev)
+            ns = "ip netns exec %s " % netns(e["node"])
+            sh(ns + "ip addr add %s/24 dev zp_%s" % (e["ip"], s))
+            sh(ns + "ip link set zp_%s up" % s)
+
+
+def down(links):
+    for link in links:
+        for e in link["ends"]:
+            s = e["suffix"]
+            for dev in (e["tap"], "zv_" + s, "zbr_" + s):
+                sh("ip link del %s" % dev, check=False)
+    for node in sorted({e["node"] for l in links for e in l["ends"]}):
+        sh("ip netns del %s" % netns(node), check=False)
+
+
+def iperf(links, args):
+    selected = [l for l in links if not args.links or l["name"] in args.links.split(",")]
+    servers, clients = [], []
+    for n, link in enumerate(selected):
+        a, b = link["ends"]
+        port = 5201 + n
+        servers.append(subprocess.Popen(
+            ["ip", "netns", "exec", netns(b["node"]), "iperf3", "-s", "-1",
+             "-B", b["ip"], "-p", str(port)],
+            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL))
+    time.sleep(1)
+    for n, link in enumerate(selected):
+        a, b = link["ends"]
+        cmd = ["ip", "netns", "exec", netns(a["node"]), "iperf3", "-J",
+               "-c", b["ip"], "-B", a["ip"], "-p", str(5201 + n),
+               "-t", str(args.duration)]
+        if args.bidir:
+            cmd.append("--bidir")
+        if args.udp:
+            cmd += ["-u", "-b", args.udp, "-l", str(args.length)]
+        clients.append(subprocess.Popen(cmd, stdout=subprocess.PIPE,
+                                        stderr=subprocess.DEVNULL, text=True))
+
+    rows = []
+    for link, client in zip(selected, clients):
+        out, _ = client.communicate()
+        row = {"link": link["name"], "cap_mbps": link["cap"]}
+        try:
+            end = json.loads(out)["end"]
+            row["ab_mbps"] = end["sum_received"]["bits_per_second"] / 1e6
+            if args.bidir:
+                row["ba_mbps"] = end["sum_received_bidir_reverse"]["bits_per_second"] / 1e6
+            if args.udp:
+                row["lost_pct"] = end["sum"]["lost_percent"]
+                row["packets"] = end["sum"]["packets"]
+        except (ValueError, KeyError):
+            row["error"] = "iperf3 failed"
+        rows.append(row)
+    for server in servers:
+        server.kill()
+    json.dump(rows, sys.stdout, indent=1)
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("action", choices=["up", "down", "iperf"])
+    parser.add_argument("config")
+    parser.add_argument("--duration", type=int, default=20)
+    parser.add_argument("--links", default="", help="comma separated link names, e.g. L1,L50")
+    parser.add_argument("--bidir", action="store_true", help="load both directions at once")
+    parser.add_argument("--udp", default="", help="UDP target rate per link (e.g. 2M) instead of TCP")
+    parser.add_argument("--length", type=int, default=1200, help="UDP datagram size")
+    args = parser.parse_args()
+
+    links = load_links(args.config)
+    if args.action == "up":
+        up(links)
+    elif args.action == "down":
+        down(links)
+    else:
+        iperf(links, args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,97 @@
+#!/bin/bash
+# Per-frame TapBridge I/O (--tapIo=single) against batched I/O
+# (--tapIo=batched) on one local TAP pair. Two stand-in nodes are joined by
+# a single 10 Gbps p2p link, so the link model is never the limit. At every
+# offered rate, UDP datagrams are pushed from node 0 to node 1 while node 0
+# pings node 1 every 10 ms. The link has no delay, so the ping RTT is the
+# latency the emulator adds in both directions (plus the veth/bridge hops).
+# Rate 0 measures the idle RTT.
+#
+# usage: sudo ./script/bench/tap_io.sh [-d seconds] [-s bytes] [pps...]
+#   e.g. sudo ./script/bench/tap_io.sh -d 20 0 20000 50000 100000 200000
+
+DURATION=20
+LENGTH=200
+while getopts "d:s:" opt; do
+    case $opt in
+        d) DURATION=$OPTARG ;;
+        s) LENGTH=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+RATES=${*:-0 10000 50000 100000 200000 400000}
+
+ROOT_DIR="$(pwd)"
+OUT_DIR="$ROOT_DIR/bench_output/tap_io"
+CONFIG="$OUT_DIR/NETWORK_CONFIG.json5"
+STANDIN="python3 script/bench/standin.py"
+WAIT_READY="python3 script/tools/wait_ready.py -q --timeout 60"
+mkdir -p "$OUT_DIR"
+
+cat > "$CONFIG" <<'EOF'
+{
+  "experiment": "tap_io",
+  "nodes": {
+    "0": {"zid": {"set": true, "value": "7a01"}, "listen_endpoints": ["tcp/10.77.1.1:8000"]},
+    "1": {"zid": {"set": true, "value": "7a02"}, "listen_endpoints": ["tcp/10.77.1.2:8001"]}
+  },
+  "links": [{"a": "0", "a_idx": 0, "b": "1", "b_idx": 0, "cap": 10000, "link_type": "p2p"}]
+}
+EOF
+
+$STANDIN down "$CONFIG"
+$STANDIN up "$CONFIG" || exit 1
+
+SUMMARY="$OUT_DIR/summary.csv"
+echo "mode,offered_pps,delivered_pps,lost_pct,rtt_avg_ms,rtt_max_ms,lag_p99_us,frames_per_event" > "$SUMMARY"
+for MODE in single batched; do
+    for PPS in $RATES; do
+        RUN_DIR="$OUT_DIR/${MODE}_$PPS"
+        rm -rf "$RUN_DIR"
+        (cd ns-3-dev && ./ns3 run "zenoh --config=$CONFIG --tapIo=$MODE --stopTime=$((DURATION + 10)) \
+            --lagThreshold=0 --scenario=none --outputDir=$RUN_DIR" --no-build) > "$RUN_DIR.log" 2>&1 &
+        NS3_PID=$!
+        $WAIT_READY "$RUN_DIR/ready.json"
+        ip netns exec zs_0 ping -q -i 0.01 -c $((DURATION * 100)) 10.77.1.2 > "$RUN_DIR.ping" 2>&1 &
+        PING_PID=$!
+        if [ "$PPS" -gt 0 ]; then
+            $STANDIN iperf "$CONFIG" --udp "$((PPS * LENGTH * 8 / 1000))K" --length "$LENGTH" \
+                --duration "$DURATION" > "$RUN_DIR.iperf.json"
+        fi
+        wait $PING_PID
+        wait $NS3_PID
+
+        python3 - "$MODE" "$PPS" "$RUN_DIR" "$DURATION" >> "$SUMMARY" <<'PY'
+import json, re, sys
+mode, pps, run_dir, duration = sys.argv[1], int(sys.argv[2]), sys.argv[3], float(sys.argv[4])
+delivered, lost = 0.0, 0.0
+if pps:
+    try:
+        row = json.load(open(run_dir + ".iperf.json"))[0]
+        delivered = row["packets"] * (1 - row["lost_pct"] / 100) / duration
+        lost = row["lost_pct"]
+    except (OSError, ValueError, KeyError, IndexError):
+        lost = 100
+rtt = re.search(r"= [\d.]+/([\d.]+)/([\d.]+)/", open(run_dir + ".ping").read())
+try:
+    p99 = json.load(open(run_dir + "/lag_summary.json"))["total"]["p99_us"]
+except (OSError, ValueError, KeyError):
+    p99 = -1
+# Only the batched bridge counts the frames it hands over per event.
+per_event = ""
+log = open(run_dir + ".log").read()
+m = re.search(r"tap io: (\d+) frames in over (\d+) events", log)
+if m and int(m.group(2)):
+    per_event = "%.1f" % (int(m.group(1)) / int(m.group(2)))
+print("%s,%d,%.0f,%.2f,%s,%s,%.0f,%s" % (mode, pps, delivered, lost,
+      rtt.group(1) if rtt else -1, rtt.group(2) if rtt else -1, p99, per_event))
+PY
+        tail -n 1 "$SUMMARY"
+    done
+done
+
+$STANDIN down "$CONFIG"
+
+echo
+column -s, -t "$SUMMARY"
@@ -1,29 +1,39 @@
-if [ -z "$1" ]; then
-    echo "usage: $0 <experiment_name>"
-    exit 1
-fi
+#!/bin/bash
+# Builds the generic emulator (script/ns3/zenoh) as ns-3's scratch/zenoh.
+# The topology is read at runtime, so this only needs to run again when the
+# emulator sources change. An optional experiment name also selects that
+# experiment's NETWORK_CONFIG.json5 for the Zenoh launcher.
 
 EXPERIMENT_NAME=$1
-SRC_DIR="script/topology/$EXPERIMENT_NAME"
+SRC_DIR="script/ns3/zenoh"
 NS3_SCRATCH_DIR="ns-3-dev/scratch"
 ZENOH_DEPLOY_DIR="zenohd-auto-deploy"
 
-if [ ! -f "$SRC_DIR/zenoh.cc" ]; then
-    echo "ERROR: $SRC_DIR/zenoh.cc not found"
-    exit 1
-fi
-
-if [ ! -f "$SRC_DIR/NETWORK_CONFIG.json5" ]; then
-    echo "ERROR: $SRC_DIR/NETWORK_CONFIG.json5 not found"
-    exit 1
+if [ -n "$EXPERIMENT_NAME" ]; then
+    CONFIG="script/topology/$EXPERIMENT_NAME/NETWORK_CONFIG.json5"
+    if [ ! -f "$CONFIG" ]; then
+        echo "ERROR: $CONFIG not found"
+        exit 1
+    fi
+    cp "$CONFIG" "$ZENOH_DEPLOY_DIR/"
+    # The emulator picks up a LINK_SCENARIO.json5 next to the config it runs.
+    SCENARIO="script/topology/$EXPERIMENT_NAME/LINK_SCENARIO.json5"
+    if [ -f "$SCENARIO" ]; then
+        cp "$SCENARIO" "$ZENOH_DEPLOY_DIR/"
+    else
+        rm -f "$ZENOH_DEPLOY_DIR/LINK_SCENARIO.json5"
+    fi
 fi
 
-cp "$SRC_DIR/zenoh.cc" "$NS3_SCRATCH_DIR/"
-cp "$SRC_DIR/NETWORK_CONFIG.json5" "$ZENOH_DEPLOY_DIR/"
+# Older per-experiment builds left a single-file scratch/zenoh.cc behind.
+rm -f "$NS3_SCRATCH_DIR/zenoh.cc"
+mkdir -p "$NS3_SCRATCH_DIR/zenoh"
+cp "$SRC_DIR"/*.h "$SRC_DIR"/*.cc "$NS3_SCRATCH_DIR/zenoh/"
 
 cd ns-3-dev || exit
-    ./ns3 clean
-    ./ns3 configure --enable-examples --enable-tests --enable-sudo
+    if [ ! -d cmake-cache ]; then
+        ./ns3 configure --enable-examples --enable-tests --enable-sudo
+    fi
     ./ns3 build
-    
-cd -
\ No newline at end of file
+
+cd -
@@ -0,0 +1,193 @@
+#ifndef ZENOH_SIM_BATCHED_TAP_BRIDGE_H
+#define ZENOH_SIM_BATCHED_TAP_BRIDGE_H
+
+#include "emulated-topology.h"
+
+#include "ns3/address.h"
+#include "ns3/callback.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Replacement for one TapBridge per link end (UseBridge mode) that moves
+ * frames in bursts instead of one at a time.
+ *
+ * TapBridge runs a reader thread per TAP that allocates a buffer for every
+ * frame, and schedules one event per frame into the real-time loop. The
+ * real-time loop writes every frame to its TAP with its own syscall.
+ *
+ * Here, one reader thread waits on all TAPs with epoll. Per wakeup it drains
+ * up to `batch` frames from each ready TAP into slots of a fixed pool and
+ * hands the burst over with one event per ns-3 node that got frames. Like
+ * TapBridge's, that event runs in the node's context, so the lag monitor
+ * charges TAP ingress to the node. It turns each slot into a packet and
+ * passes it to the bridged device with SendFrom, as TapBridge does. In the
+ * other direction the real-time loop copies each frame into a pool slot and
+ * queues it. One writer thread drains the queue, and is woken at most once
+ * per burst. The pools are allocated once, so the
+ * steady state does not allocate beyond the ns-3 packets themselves, which
+ * take their buffers from ns-3's own free list.
+ *
+ * A TAP fd takes one frame per read() or write(), so those syscalls remain.
+ * They are batched per wakeup and run off the real-time loop.
+ *
+ * Statistics go to tap_io.csv, one row per TAP.
+ */
+class BatchedTapBridge {
+ public:
+  BatchedTapBridge(EmulatedTopology& topology, const std::string& outputDir);
+  ~BatchedTapBridge();
+
+  /// Frames read from one TAP per wakeup before moving to the next (default 64).
+  void SetBatch(uint32_t frames);
+  /// Slots of the receive and of the transmit pool (default 8192 each).
+  void SetPoolFrames(uint32_t frames);
+  /// Called from Start with each link end's index (2 * link + side) once its TAP is open.
+  void SetAttachedCallback(Callback<void, uint32_t> attached);
+
+  /// Opens every link end's TAP and hooks its device; the I/O threads start at time 0.
+  void Start();
+  /// Stops the threads and writes tap_io.csv; call after Simulator::Run.
+  void Finish();
+
+ private:
+  /// Frames of up to a 1500 byte MTU plus the Ethernet and a VLAN header.
+  static constexpr uint32_t kSlotBytes = 2048;
+  static constexpr uint32_t kEthernetHeader = 14;
+
+  /// Lock-free queue between exactly one producer and one consumer thread.
+  template <typename T>
+  class SpscRing {
+   public:
+    void Reset(uint32_t capacity) {
+      uint32_t size = 1;
+      while (size < capacity) {
+        size <<= 1;
+      }
+      m_items.assign(size, T());
+      m_mask = size - 1;
+      m_head = 0;
+      m_tail = 0;
+    }
+    bool Push(const T& item) {
+      uint64_t head = m_head.load(std::memory_order_relaxed);
+      if (head - m_tail.load(std::memory_order_acquire) > m_mask) {
+        return false;
+      }
+      m_items[head & m_mask] = item;
+      m_head.store(head + 1);
+      return true;
+    }
+    bool Pop(T& item) {
+      uint64_t tail = m_tail.load(std::memory_order_relaxed);
+      if (tail == m_head.load()) {
+        return false;
+      }
+      item = m_items[tail & m_mask];
+      m_tail.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+    bool Empty() const { return m_tail.load() == m_head.load(); }
+
+   private:
+    std::vector<T> m_items;
+    uint64_t m_mask = 0;
+    std::atomic<uint64_t> m_head{0};
+    std::atomic<uint64_t> m_tail{0};
+  };
+
+  struct FrameRef {
+    uint32_t slot;
+    uint32_t endpoint;
+    uint32_t length;
+  };
+
+  struct Endpoint {
+    BatchedTapBridge* bridge;
+    uint32_t index;
+    std::string tapName;
+    std::string linkName;
+    Ptr<NetDevice> device;
+    uint32_t node;  ///< ns-3 node id, the context its frames are delivered in
+    int fd;
+    // reader thread
+    uint64_t rxFrames;
+    uint64_t rxBytes;
+    uint64_t rxBursts;
+    uint32_t rxMaxBurst;
+    uint64_t rxDrops;  ///< runts, oversized frames and read errors
+    // simulator thread
+    uint64_t rxHeaderDrops;  ///< 802.3 frames too short for their LLC/SNAP header
+    uint64_t txPoolDrops;
+    // writer thread
+    uint64_t txFrames;
+    uint64_t txBytes;
+    uint64_t txErrors;
+  };
+
+  static void OnDeviceRx(Endpoint* ep,
+                         Ptr<NetDevice> device,
+                         Ptr<const Packet> packet,
+                         uint16_t protocol,
+                         const Address& from,
+                         const Address& to,
+                         NetDevice::PacketType type);
+  /// Frames read for the TAPs of one node, delivered by one event at a time.
+  struct NodeQueue {
+    uint32_t node;
+    SpscRing<FrameRef> frames;  ///< reader -> simulator
+    std::atomic<bool> pending{false};
+    bool touched = false;  ///< reader thread: got frames in this wakeup
+  };
+
+  void StartThreads();
+  void ReaderLoop();
+  void WriterLoop();
+  void Deliver(NodeQueue* queue);
+  void Forward(const FrameRef& frame);
+  uint8_t* Slot(std::vector<uint8_t>& pool, uint32_t slot);
+  void WriteStats();
+
+  EmulatedTopology& m_topology;
+  std::string m_outputDir;
+  uint32_t m_batch;
+  uint32_t m_poolFrames;
+  Callback<void, uint32_t> m_attached;
+  bool m_started;
+
+  std::vector<Endpoint> m_endpoints;
+  std::vector<std::unique_ptr<NodeQueue>> m_nodeQueues;  ///< [node id], null without TAPs
+  std::vector<uint8_t> m_rxPool;
+  std::vector<uint8_t> m_txPool;
+  SpscRing<uint32_t> m_rxFree;   ///< simulator -> reader
+  SpscRing<FrameRef> m_txQueue;  ///< simulator -> writer
+  SpscRing<uint32_t> m_txFree;   ///< writer -> simulator
+
+  int m_epollFd;
+  int m_readerWakeFd;  ///< stop, or slots returned to a starved reader
+  int m_writerWakeFd;
+  std::atomic<bool> m_stop;
+  std::atomic<bool> m_readerStarved;
+  std::atomic<bool> m_writerAwake;
+  std::thread m_reader;
+  std::thread m_writer;
+
+  uint64_t m_readerWakeups;  ///< reader thread
+  uint64_t m_starved;        ///< reader thread
+  uint64_t m_deliveries;     ///< simulator thread, events over all nodes
+  uint32_t m_maxDelivery;    ///< simulator thread, frames
+  uint64_t m_writerWakeups;  ///< writer thread
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_BATCHED_TAP_BRIDGE_H
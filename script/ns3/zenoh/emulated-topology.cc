@@ -0,0 +1,109 @@
+#include "emulated-topology.h"
+
+#include "p2p-ethernet-channel.h"
+#include "p2p-ethernet-net-device.h"
+
+#include "ns3/csma-module.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/tap-bridge-module.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("EmulatedTopology");
+
+EmulatedTopology::EmulatedTopology(const NetworkConfig& config) : m_config(config) {}
+
+Ptr<Node> EmulatedTopology::GetNode(const std::string& id) const {
+  return m_nodes.Get(m_config.NodeIndex(id));
+}
+
+NetDeviceContainer EmulatedTopology::InstallCsma(NodeContainer pair, DataRate rate, Time delay) {
+  CsmaHelper csma;
+  csma.SetChannelAttribute("DataRate", DataRateValue(rate));
+  csma.SetChannelAttribute("Delay", TimeValue(delay));
+  return csma.Install(pair);
+}
+
+NetDeviceContainer EmulatedTopology::InstallP2p(NodeContainer pair, DataRate rate, Time delay) {
+  Ptr<P2pEthernetChannel> channel = CreateObject<P2pEthernetChannel>();
+  channel->SetAttribute("Delay", TimeValue(delay));
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 2; ++i) {
+    Ptr<P2pEthernetNetDevice> device = CreateObject<P2pEthernetNetDevice>();
+    device->SetAddress(Mac48Address::Allocate());
+    device->SetDataRate(rate);
+    device->SetQueue(CreateObject<DropTailQueue<Packet>>());
+    pair.Get(i)->AddDevice(device);
+    device->Attach(channel);
+    devices.Add(device);
+  }
+  return devices;
+}
+
+void EmulatedTopology::Build() {
+  std::vector<uint32_t> all(m_config.links.size());
+  for (uint32_t i = 0; i < all.size(); ++i) {
+    all[i] = i;
+  }
+  Build(all);
+}
+
+void EmulatedTopology::Build(const std::vector<uint32_t>& linkIndices) {
+  // ns-3 node i is the i-th entry of `nodes`, so node ids like "16" keep
+  // their number whenever the config lists them in order.
+  m_nodes.Create(m_config.nodes.size());
+
+  for (uint32_t i : linkIndices) {
+    const LinkConfig& lc = m_config.links[i];
+    EmulatedLink link;
+    link.index = i;
+    link.name = lc.Name(i);
+    link.config = lc;
+
+    link.type = m_config.LinkType(lc);
+
+    DataRate rate(static_cast<uint64_t>(lc.capMbps * 1e6));
+    Time delay = Seconds(lc.delayMs / 1000.0);
+    NodeContainer pair(GetNode(lc.a), GetNode(lc.b));
+    NetDeviceContainer devices =
+        link.type == "p2p" ? InstallP2p(pair, rate, delay) : InstallCsma(pair, rate, delay);
+    link.channel = devices.Get(0)->GetChannel();
+
+    const std::string ids[2] = {lc.a, lc.b};
+    const uint32_t idxs[2] = {lc.aIdx, lc.bIdx};
+    for (int side = 0; side < 2; ++side) {
+      LinkEndpoint& end = link.ends[side];
+      end.nodeId = ids[side];
+      end.endpointIdx = idxs[side];
+      end.tapName = NetworkConfig::TapName(ids[side], idxs[side]);
+      end.node = GetNode(ids[side]);
+      end.device = devices.Get(side);
+    }
+    NS_LOG_INFO(link.name << ": " << link.ends[0].tapName << " <-> " << link.ends[1].tapName
+                          << " " << link.type << " " << lc.capMbps << "Mbps " << lc.delayMs
+                          << "ms");
+    m_links.push_back(link);
+  }
+}
+
+void EmulatedTopology::InstallTapBridges(Callback<void, uint32_t> attached) {
+  TapBridgeHelper tb;
+  tb.SetAttribute("Mode", StringValue("UseBridge"));
+  uint32_t i = 0;
+  for (auto& link : m_links) {
+    for (auto& end : link.ends) {
+      tb.SetAttribute("DeviceName", StringValue(end.tapName));
+      tb.Install(end.node, end.device);
+      // A TapBridge opens its TAP in an event at time 0 scheduled on creation,
+      // so this one runs right after it.
+      if (!attached.IsNull()) {
+        Simulator::ScheduleNow(attached, i);
+      }
+      ++i;
+    }
+  }
+}
+
+}  // namespace ns3
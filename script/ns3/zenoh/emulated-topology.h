@@ -0,0 +1,74 @@
+#ifndef ZENOH_SIM_EMULATED_TOPOLOGY_H
+#define ZENOH_SIM_EMULATED_TOPOLOGY_H
+
+#include "network-config.h"
+
+#include "ns3/callback.h"
+#include "ns3/channel.h"
+#include "ns3/data-rate.h"
+#include "ns3/net-device-container.h"
+#include "ns3/net-device.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/// One side of an emulated link: the ns-3 device bridged to a container TAP.
+struct LinkEndpoint {
+  std::string nodeId;
+  uint32_t endpointIdx;
+  std::string tapName;
+  Ptr<Node> node;
+  Ptr<NetDevice> device;
+};
+
+/// An emulated two-router link built from one `links` entry.
+struct EmulatedLink {
+  uint32_t index;  ///< position in `links`
+  std::string name;
+  std::string type;  ///< "csma" or "p2p"
+  LinkConfig config;
+  Ptr<Channel> channel;
+  LinkEndpoint ends[2];  ///< [0] is `a`, [1] is `b`
+};
+
+/**
+ * Builds the ns-3 side of an experiment from NETWORK_CONFIG.json5: one node
+ * per config node, one L2 channel per link with the link's `cap` and `delay`,
+ * and optionally one TapBridge per link end named tap_<node>_<idx>.
+ *
+ * Links are half-duplex CSMA segments (`link_type: "csma"`, the historical
+ * model) or full-duplex P2pEthernet cables (`link_type: "p2p"`).
+ */
+class EmulatedTopology {
+ public:
+  explicit EmulatedTopology(const NetworkConfig& config);
+
+  /// Creates the nodes and the channels of every link.
+  void Build();
+  /// Creates the nodes and only the listed links (indices into `links`).
+  void Build(const std::vector<uint32_t>& linkIndices);
+  /// Attaches every link end to its container TAP in UseBridge mode. `attached`
+  /// is called with the end's index (2 * link + side) once its TAP is open.
+  void InstallTapBridges(Callback<void, uint32_t> attached = MakeNullCallback<void, uint32_t>());
+
+  const NetworkConfig& GetConfig() const { return m_config; }
+  NodeContainer& GetNodes() { return m_nodes; }
+  std::vector<EmulatedLink>& GetLinks() { return m_links; }
+  Ptr<Node> GetNode(const std::string& id) const;
+
+ private:
+  NetDeviceContainer InstallCsma(NodeContainer pair, DataRate rate, Time delay);
+  NetDeviceContainer InstallP2p(NodeContainer pair, DataRate rate, Time delay);
+
+  const NetworkConfig& m_config;
+  NodeContainer m_nodes;
+  std::vector<EmulatedLink> m_links;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_EMULATED_TOPOLOGY_H
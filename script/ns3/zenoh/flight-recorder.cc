@@ -0,0 +1,350 @@
+#include "flight-recorder.h"
+
+#include "ns3/abort.h"
+#include "ns3/callback.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/queue.h"
+#include "ns3/simulator.h"
+#include "ns3/system-path.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("FlightRecorder");
+
+namespace {
+
+volatile std::sig_atomic_t g_dumpRequested = 0;
+
+const uint32_t kMinSlots = 1024;
+const uint32_t kPcapMagicNs = 0xa1b23c4d;
+const uint32_t kLinkTypeEthernet = 1;
+
+int64_t WallNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+FlightRecorder::FlightRecorder(EmulatedTopology& topology, const std::string& outputDir)
+    : m_topology(topology),
+      m_dir(outputDir + "/recorder"),
+      m_pre(Seconds(10)),
+      m_post(Seconds(5)),
+      m_snaplen(128),
+      m_memory(512ull << 20),
+      m_queueThreshold(0),
+      m_dropBurst(0),
+      m_dropWindow(MilliSeconds(100)),
+      m_wallOriginNs(0),
+      m_triggers(0),
+      m_running(false),
+      m_stopWriter(false) {}
+
+FlightRecorder::~FlightRecorder() {
+  Finish();
+}
+
+void FlightRecorder::SetWindow(Time pre, Time post) {
+  m_pre = pre;
+  m_post = post;
+}
+
+void FlightRecorder::SetSnaplen(uint32_t bytes) {
+  m_snaplen = std::max<uint32_t>(bytes, 14);
+}
+
+void FlightRecorder::SetMemory(uint64_t bytes) {
+  m_memory = bytes;
+}
+
+void FlightRecorder::SetQueueTrigger(uint32_t packets) {
+  m_queueThreshold = packets;
+}
+
+void FlightRecorder::SetDropTrigger(uint32_t drops, Time window) {
+  m_dropBurst = drops;
+  m_dropWindow = window;
+}
+
+void FlightRecorder::ScheduleDump(Time at) {
+  m_scheduled.push_back(at);
+}
+
+void FlightRecorder::Start() {
+  SystemPath::MakeDirectories(m_dir);
+
+  // Split the memory budget by link capacity, which bounds the frame rate.
+  double totalCap = 0;
+  for (const auto& link : m_topology.GetLinks()) {
+    totalCap += 2 * link.config.capMbps;
+  }
+  uint64_t perSlot = m_snaplen + sizeof(Record);
+  uint64_t allocated = 0;
+  for (uint32_t l = 0; l < m_topology.GetLinks().size(); ++l) {
+    const EmulatedLink& link = m_topology.GetLinks()[l];
+    // Never more slots than minimum-size frames at line rate can fill.
+    uint64_t share = static_cast<uint64_t>(m_memory * (link.config.capMbps / totalCap)) / perSlot;
+    uint64_t lineRate = static_cast<uint64_t>(link.config.capMbps * 1e6 / 8 / 64 *
+                                              (m_pre + m_post).GetSeconds());
+    uint32_t slots = static_cast<uint32_t>(
+        std::max<uint64_t>(kMinSlots, std::min<uint64_t>(share, std::max<uint64_t>(lineRate, 1))));
+    for (uint8_t side = 0; side < 2; ++side) {
+      auto ring = std::make_unique<Ring>();
+      ring->recorder = this;
+      ring->link = l;
+      ring->side = side;
+      ring->slots = slots;
+      ring->data.assign(static_cast<size_t>(slots) * m_snaplen, 0);
+      ring->records.assign(slots, Record{0, 0, 0});
+      ring->head = 0;
+      ring->readPos.store(kIdle);
+      ring->lost = 0;
+      ring->scheduled = false;
+      ring->holdUntil = Seconds(0);
+      ring->drops.assign(std::max<uint32_t>(m_dropBurst, 1), -1);
+      ring->dropIdx = 0;
+      allocated += static_cast<uint64_t>(slots) * perSlot;
+
+      Ptr<NetDevice> device = link.ends[side].device;
+      device->TraceConnectWithoutContext("MacTx",
+                                         MakeBoundCallback(&FlightRecorder::OnFrame, ring.get()));
+      device->TraceConnectWithoutContext("MacPromiscRx",
+                                         MakeBoundCallback(&FlightRecorder::OnFrame, ring.get()));
+      if (m_dropBurst > 0) {
+        device->TraceConnectWithoutContext("MacTxDrop",
+                                           MakeBoundCallback(&FlightRecorder::OnDrop, ring.get()));
+        device->TraceConnectWithoutContext("PhyRxDrop",
+                                           MakeBoundCallback(&FlightRecorder::OnDrop, ring.get()));
+      }
+      if (m_queueThreshold > 0) {
+        PointerValue queue;
+        device->GetAttribute("TxQueue", queue);
+        queue.Get<Queue<Packet>>()->TraceConnectWithoutContext(
+            "PacketsInQueue", MakeBoundCallback(&FlightRecorder::OnQueueDepth, ring.get()));
+      }
+      m_rings.push_back(std::move(ring));
+    }
+  }
+
+  m_log.open(m_dir + "/triggers.csv");
+  m_log << "id,sim_s,wall_time,reason,link,detail,files\n";
+  m_wallOriginNs = WallNs() - Simulator::Now().GetNanoSeconds();
+  m_writer = std::thread(&FlightRecorder::WriterLoop, this);
+  m_running = true;
+
+  g_dumpRequested = 0;
+  std::signal(SIGUSR1, &FlightRecorder::OnSignal);
+  Simulator::Schedule(MilliSeconds(100), &FlightRecorder::PollSignal, this);
+  for (const Time& at : m_scheduled) {
+    Simulator::Schedule(Max(at - Simulator::Now(), Seconds(0)), &FlightRecorder::Trigger, this,
+                        std::string("scheduled"), static_cast<Ring*>(nullptr), std::string());
+  }
+  NS_LOG_UNCOND("flight recorder: " << (allocated >> 20) << " MiB of rings, "
+                                    << "kill -USR1 " << getpid() << " dumps every link");
+}
+
+void FlightRecorder::OnFrame(Ring* ring, Ptr<const Packet> packet) {
+  uint64_t idx = ring->head;
+  uint64_t reader = ring->readPos.load(std::memory_order_acquire);
+  if (reader != kIdle && idx - reader >= ring->slots) {
+    // The writer has not got past this slot yet.
+    ++ring->lost;
+    return;
+  }
+  uint32_t slot = idx % ring->slots;
+  uint32_t snaplen = ring->recorder->m_snaplen;
+  Record& r = ring->records[slot];
+  r.ts = Simulator::Now().GetNanoSeconds();
+  r.origLen = packet->GetSize();
+  r.capLen = packet->CopyData(&ring->data[static_cast<size_t>(slot) * snaplen],
+                              std::min(r.origLen, snaplen));
+  ring->head = idx + 1;
+}
+
+void FlightRecorder::OnDrop(Ring* ring, Ptr<const Packet> packet) {
+  FlightRecorder* self = ring->recorder;
+  int64_t now = Simulator::Now().GetNanoSeconds();
+  ring->drops[ring->dropIdx] = now;
+  ring->dropIdx = (ring->dropIdx + 1) % ring->drops.size();
+  // Now drops[dropIdx] is the oldest of the last m_dropBurst drops, this one included.
+  int64_t oldest = ring->drops[ring->dropIdx];
+  if (oldest >= 0 && now - oldest <= self->m_dropWindow.GetNanoSeconds()) {
+    std::ostringstream detail;
+    detail << self->m_dropBurst << " drops in " << (now - oldest) / 1e6 << " ms";
+    self->Trigger("drops", ring, detail.str());
+  }
+}
+
+void FlightRecorder::OnQueueDepth(Ring* ring, uint32_t oldValue, uint32_t newValue) {
+  FlightRecorder* self = ring->recorder;
+  if (newValue > self->m_queueThreshold && oldValue <= self->m_queueThreshold) {
+    std::ostringstream detail;
+    detail << newValue << " packets queued";
+    self->Trigger("queue", ring, detail.str());
+  }
+}
+
+void FlightRecorder::OnSignal(int) {
+  g_dumpRequested = 1;
+}
+
+void FlightRecorder::PollSignal() {
+  if (g_dumpRequested) {
+    g_dumpRequested = 0;
+    Trigger("signal", nullptr, "");
+  }
+  Simulator::Schedule(MilliSeconds(100), &FlightRecorder::PollSignal, this);
+}
+
+void FlightRecorder::Trigger(const std::string& reason, Ring* ring, const std::string& detail) {
+  Time now = Simulator::Now();
+  PendingDump dump{0, reason, now - m_pre, {}, false};
+  for (auto& candidate : m_rings) {
+    if (ring && candidate->link != ring->link) {
+      continue;
+    }
+    // One dump per ring at a time; an ongoing episode does not retrigger.
+    if (candidate->scheduled || candidate->readPos.load() != kIdle ||
+        now < candidate->holdUntil) {
+      continue;
+    }
+    candidate->scheduled = true;
+    candidate->holdUntil = now + m_pre + m_post;
+    dump.rings.push_back(candidate.get());
+  }
+  if (dump.rings.empty()) {
+    return;
+  }
+  dump.id = ++m_triggers;
+
+  std::string link = ring ? m_topology.GetLinks()[ring->link].name : "all";
+  NS_LOG_UNCOND("t=" << now.GetSeconds() << "s flight recorder trigger " << dump.id << ": "
+                     << reason << " " << link << (detail.empty() ? "" : " (" + detail + ")"));
+  m_log << dump.id << "," << now.GetSeconds() << "," << std::fixed << std::setprecision(6)
+        << (m_wallOriginNs + now.GetNanoSeconds()) / 1e9 << std::defaultfloat << "," << reason
+        << "," << link << "," << detail << ",";
+  for (uint32_t i = 0; i < dump.rings.size(); ++i) {
+    const Ring* r = dump.rings[i];
+    m_log << (i ? " " : "") << dump.id << "_" << reason << "_"
+          << m_topology.GetLinks()[r->link].ends[r->side].tapName << ".pcap";
+  }
+  m_log << std::endl;
+
+  m_pending.push_back(dump);
+  Simulator::Schedule(m_post, &FlightRecorder::Dump, this,
+                      static_cast<uint32_t>(m_pending.size() - 1));
+}
+
+void FlightRecorder::Dump(uint32_t pending) {
+  PendingDump& dump = m_pending[pending];
+  if (dump.done) {
+    return;
+  }
+  dump.done = true;
+  int64_t from = dump.from.GetNanoSeconds();
+  for (Ring* ring : dump.rings) {
+    ring->scheduled = false;
+    // Records are in time order: find the first one inside the window.
+    uint64_t lo = ring->head > ring->slots ? ring->head - ring->slots : 0;
+    uint64_t hi = ring->head;
+    while (lo < hi) {
+      uint64_t mid = lo + (hi - lo) / 2;
+      if (ring->records[mid % ring->slots].ts < from) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    std::ostringstream path;
+    path << m_dir << "/" << dump.id << "_" << dump.reason << "_"
+         << m_topology.GetLinks()[ring->link].ends[ring->side].tapName << ".pcap";
+    // From here on the simulator must not overwrite records the writer needs.
+    ring->readPos.store(lo, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_jobs.push_back(Job{ring, lo, ring->head, path.str()});
+  }
+  m_cv.notify_one();
+}
+
+void FlightRecorder::WriterLoop() {
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [this] { return m_stopWriter || !m_jobs.empty(); });
+      if (m_jobs.empty()) {
+        return;
+      }
+      job = m_jobs.front();
+      m_jobs.pop_front();
+    }
+    WritePcap(job);
+  }
+}
+
+void FlightRecorder::WritePcap(const Job& job) {
+  Ring* ring = job.ring;
+  std::FILE* f = std::fopen(job.path.c_str(), "wb");
+  if (f) {
+    uint32_t header[6] = {kPcapMagicNs, 2 | 4 << 16, 0, 0, m_snaplen, kLinkTypeEthernet};
+    std::fwrite(header, sizeof(header), 1, f);
+  } else {
+    NS_LOG_WARN("cannot open " << job.path);
+  }
+  for (uint64_t idx = job.begin; idx < job.end; ++idx) {
+    uint32_t slot = idx % ring->slots;
+    const Record& r = ring->records[slot];
+    if (f) {
+      int64_t ts = m_wallOriginNs + r.ts;
+      uint32_t rec[4] = {static_cast<uint32_t>(ts / 1000000000),
+                         static_cast<uint32_t>(ts % 1000000000), r.capLen, r.origLen};
+      std::fwrite(rec, sizeof(rec), 1, f);
+      std::fwrite(&ring->data[static_cast<size_t>(slot) * m_snaplen], 1, r.capLen, f);
+    }
+    ring->readPos.store(idx + 1, std::memory_order_release);
+  }
+  if (f) {
+    std::fclose(f);
+  }
+  ring->readPos.store(kIdle, std::memory_order_release);
+}
+
+void FlightRecorder::Finish() {
+  if (!m_running) {
+    return;
+  }
+  m_running = false;
+  std::signal(SIGUSR1, SIG_DFL);
+  // Triggers whose post window did not end before the run stopped.
+  for (uint32_t i = 0; i < m_pending.size(); ++i) {
+    Dump(i);
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopWriter = true;
+  }
+  m_cv.notify_one();
+  m_writer.join();
+  m_log.close();
+
+  uint64_t lost = 0;
+  for (const auto& ring : m_rings) {
+    lost += ring->lost;
+  }
+  NS_LOG_UNCOND("flight recorder: " << m_triggers << " triggers, dumps in " << m_dir
+                                    << (lost ? ", frames missed while writing: " : "")
+                                    << (lost ? std::to_string(lost) : ""));
+}
+
+}  // namespace ns3
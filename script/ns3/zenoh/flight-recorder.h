@@ -0,0 +1,141 @@
+#ifndef ZENOH_SIM_FLIGHT_RECORDER_H
+#define ZENOH_SIM_FLIGHT_RECORDER_H
+
+#include "emulated-topology.h"
+
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Flight recorder: every link end keeps the frames its TAP sent and received
+ * in a preallocated in-memory ring, truncated to a snaplen. Nothing is written
+ * until a trigger fires:
+ *
+ *  - a device queue holds more than a given number of packets,
+ *  - a burst of drops (MAC or link-down/loss) on one device,
+ *  - SIGUSR1 sent to the emulator,
+ *  - a scheduled simulation time.
+ *
+ * A trigger waits `post` seconds and then writes `pre` + `post` seconds of
+ * frames to pcap files under recorder/: the triggering link for queue and drop
+ * triggers, every link for signals and scheduled dumps. The pcaps are written
+ * by a background thread straight from the rings, so the real-time loop only
+ * pays for copying snaplen bytes per frame. recorder/triggers.csv lists every
+ * trigger with its time and files.
+ *
+ * The rings share a memory budget in proportion to link capacity; on a busy
+ * link a ring may cover less than `pre` + `post` seconds.
+ */
+class FlightRecorder {
+ public:
+  FlightRecorder(EmulatedTopology& topology, const std::string& outputDir);
+  ~FlightRecorder();
+
+  /// Seconds kept before a trigger and recorded after it (default 10 and 5).
+  void SetWindow(Time pre, Time post);
+  void SetSnaplen(uint32_t bytes);
+  void SetMemory(uint64_t bytes);
+  /// Triggers when a device queue holds more than `packets` (0: off).
+  void SetQueueTrigger(uint32_t packets);
+  /// Triggers on `drops` drops within `window` on one device (0: off).
+  void SetDropTrigger(uint32_t drops, Time window);
+  /// Dumps every link at simulation time `at`.
+  void ScheduleDump(Time at);
+
+  /// Allocates the rings, hooks the devices and SIGUSR1, starts the writer.
+  void Start();
+  /// Writes the dumps still waiting for their post window and stops the writer.
+  void Finish();
+
+ private:
+  static constexpr uint64_t kIdle = ~static_cast<uint64_t>(0);
+
+  struct Record {
+    int64_t ts;  ///< simulation ns
+    uint32_t origLen;
+    uint32_t capLen;
+  };
+
+  struct Ring {
+    FlightRecorder* recorder;
+    uint32_t link;  ///< position in the topology's links
+    uint8_t side;
+    uint32_t slots;
+    std::vector<uint8_t> data;
+    std::vector<Record> records;
+    uint64_t head;                  ///< next record index, simulator thread only
+    std::atomic<uint64_t> readPos;  ///< next record the writer reads, kIdle if none
+    uint64_t lost;                  ///< frames not recorded while a dump was slow
+    bool scheduled;                 ///< a dump is waiting for its post window
+    Time holdUntil;
+    std::vector<int64_t> drops;     ///< times of the last drops, circular
+    uint32_t dropIdx;
+  };
+
+  struct PendingDump {
+    uint32_t id;
+    std::string reason;
+    Time from;
+    std::vector<Ring*> rings;
+    bool done;
+  };
+
+  struct Job {
+    Ring* ring;
+    uint64_t begin;
+    uint64_t end;
+    std::string path;
+  };
+
+  static void OnFrame(Ring* ring, Ptr<const Packet> packet);
+  static void OnDrop(Ring* ring, Ptr<const Packet> packet);
+  static void OnQueueDepth(Ring* ring, uint32_t oldValue, uint32_t newValue);
+  static void OnSignal(int signo);
+
+  void Trigger(const std::string& reason, Ring* ring, const std::string& detail);
+  void Dump(uint32_t pending);
+  void PollSignal();
+  void WriterLoop();
+  void WritePcap(const Job& job);
+
+  EmulatedTopology& m_topology;
+  std::string m_dir;
+  Time m_pre;
+  Time m_post;
+  uint32_t m_snaplen;
+  uint64_t m_memory;
+  uint32_t m_queueThreshold;
+  uint32_t m_dropBurst;
+  Time m_dropWindow;
+  std::vector<Time> m_scheduled;
+
+  std::vector<std::unique_ptr<Ring>> m_rings;  ///< [link * 2 + side]
+  int64_t m_wallOriginNs;                      ///< wall clock at simulation time 0
+  uint32_t m_triggers;
+  std::vector<PendingDump> m_pending;
+  std::ofstream m_log;
+  bool m_running;
+
+  std::thread m_writer;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<Job> m_jobs;
+  bool m_stopWriter;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_FLIGHT_RECORDER_H
@@ -0,0 +1,328 @@
+#include "json5.h"
+
+#include "ns3/abort.h"
+#include "ns3/fatal-error.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+
+class Json5Parser {
+ public:
+  Json5Parser(const std::string& text, const std::string& origin)
+      : m_text(text), m_origin(origin), m_pos(0) {}
+
+  Json5Value ParseDocument() {
+    Json5Value value = ParseValue();
+    SkipSpace();
+    if (m_pos != m_text.size()) {
+      Fail("trailing characters after document");
+    }
+    return value;
+  }
+
+ private:
+  [[noreturn]] void Fail(const std::string& what) const {
+    uint32_t line = 1;
+    uint32_t col = 1;
+    for (size_t i = 0; i < m_pos && i < m_text.size(); ++i) {
+      if (m_text[i] == '\n') {
+        ++line;
+        col = 1;
+      } else {
+        ++col;
+      }
+    }
+    NS_FATAL_ERROR(m_origin << ":" << line << ":" << col << ": " << what);
+  }
+
+  char Peek() const { return m_pos < m_text.size() ? m_text[m_pos] : '\0'; }
+
+  void SkipSpace() {
+    while (m_pos < m_text.size()) {
+      char c = m_text[m_pos];
+      if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+        ++m_pos;
+      } else if (c == '/' && m_pos + 1 < m_text.size() && m_text[m_pos + 1] == '/') {
+        while (m_pos < m_text.size() && m_text[m_pos] != '\n') {
+          ++m_pos;
+        }
+      } else if (c == '/' && m_pos + 1 < m_text.size() && m_text[m_pos + 1] == '*') {
+        size_t end = m_text.find("*/", m_pos + 2);
+        if (end == std::string::npos) {
+          Fail("unterminated block comment");
+        }
+        m_pos = end + 2;
+      } else if (static_cast<unsigned char>(c) == 0xc2 && m_pos + 1 < m_text.size() &&
+                 static_cast<unsigned char>(m_text[m_pos + 1]) == 0xa0) {
+        m_pos += 2;  // non-breaking space
+      } else {
+        break;
+      }
+    }
+  }
+
+  void Expect(char c) {
+    SkipSpace();
+    if (Peek() != c) {
+      Fail(std::string("expected '") + c + "'");
+    }
+    ++m_pos;
+  }
+
+  static bool IsIdentStart(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '$';
+  }
+
+  static bool IsIdentPart(char c) { return IsIdentStart(c) || (c >= '0' && c <= '9'); }
+
+  std::string ParseIdentifier() {
+    size_t start = m_pos;
+    while (m_pos < m_text.size() && IsIdentPart(m_text[m_pos])) {
+      ++m_pos;
+    }
+    return m_text.substr(start, m_pos - start);
+  }
+
+  std::string ParseString() {
+    char quote = m_text[m_pos++];
+    std::string out;
+    while (true) {
+      if (m_pos >= m_text.size()) {
+        Fail("unterminated string");
+      }
+      char c = m_text[m_pos++];
+      if (c == quote) {
+        break;
+      }
+      if (c != '\\') {
+        out += c;
+        continue;
+      }
+      if (m_pos >= m_text.size()) {
+        Fail("unterminated escape");
+      }
+      char e = m_text[m_pos++];
+      switch (e) {
+        case 'n': out += '\n'; break;
+        case 't': out += '\t'; break;
+        case 'r': out += '\r'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case '0': out += '\0'; break;
+        case '\n': break;  // line continuation
+        case 'u': {
+          if (m_pos + 4 > m_text.size()) {
+            Fail("truncated \\u escape");
+          }
+          uint32_t cp = std::strtoul(m_text.substr(m_pos, 4).c_str(), nullptr, 16);
+          m_pos += 4;
+          if (cp < 0x80) {
+            out += static_cast<char>(cp);
+          } else if (cp < 0x800) {
+            out += static_cast<char>(0xc0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+          } else {
+            out += static_cast<char>(0xe0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+          }
+          break;
+        }
+        default: out += e; break;
+      }
+    }
+    return out;
+  }
+
+  double ParseNumber() {
+    size_t start = m_pos;
+    bool negative = false;
+    if (Peek() == '+' || Peek() == '-') {
+      negative = Peek() == '-';
+      ++m_pos;
+    }
+    if (m_text.compare(m_pos, 8, "Infinity") == 0) {
+      m_pos += 8;
+      return negative ? -INFINITY : INFINITY;
+    }
+    if (m_text.compare(m_pos, 3, "NaN") == 0) {
+      m_pos += 3;
+      return NAN;
+    }
+    const char* begin = m_text.c_str() + m_pos;
+    char* end = nullptr;
+    double value;
+    if (m_text.compare(m_pos, 2, "0x") == 0 || m_text.compare(m_pos, 2, "0X") == 0) {
+      value = static_cast<double>(std::strtoull(begin, &end, 16));
+    } else {
+      value = std::strtod(begin, &end);
+    }
+    if (end == begin) {
+      m_pos = start;
+      Fail("invalid number");
+    }
+    m_pos += end - begin;
+    return negative ? -value : value;
+  }
+
+  Json5Value ParseValue() {
+    SkipSpace();
+    Json5Value value;
+    char c = Peek();
+    if (c == '{') {
+      ++m_pos;
+      value.m_type = Json5Value::OBJECT;
+      while (true) {
+        SkipSpace();
+        if (Peek() == '}') {
+          ++m_pos;
+          break;
+        }
+        std::string key;
+        if (Peek() == '"' || Peek() == '\'') {
+          key = ParseString();
+        } else if (IsIdentStart(Peek())) {
+          key = ParseIdentifier();
+        } else {
+          Fail("expected object key");
+        }
+        Expect(':');
+        value.m_members.emplace_back(key, ParseValue());
+        SkipSpace();
+        if (Peek() == ',') {
+          ++m_pos;
+        } else if (Peek() != '}') {
+          Fail("expected ',' or '}'");
+        }
+      }
+    } else if (c == '[') {
+      ++m_pos;
+      value.m_type = Json5Value::ARRAY;
+      while (true) {
+        SkipSpace();
+        if (Peek() == ']') {
+          ++m_pos;
+          break;
+        }
+        value.m_elements.push_back(ParseValue());
+        SkipSpace();
+        if (Peek() == ',') {
+          ++m_pos;
+        } else if (Peek() != ']') {
+          Fail("expected ',' or ']'");
+        }
+      }
+    } else if (c == '"' || c == '\'') {
+      value.m_type = Json5Value::STRING;
+      value.m_string = ParseString();
+    } else if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.') {
+      value.m_type = Json5Value::NUMBER;
+      value.m_number = ParseNumber();
+    } else if (IsIdentStart(c)) {
+      size_t start = m_pos;
+      std::string word = ParseIdentifier();
+      if (word == "true" || word == "false") {
+        value.m_type = Json5Value::BOOL;
+        value.m_bool = word == "true";
+      } else if (word == "null") {
+        value.m_type = Json5Value::NUL;
+      } else if (word == "Infinity" || word == "NaN") {
+        m_pos = start;
+        value.m_type = Json5Value::NUMBER;
+        value.m_number = ParseNumber();
+      } else {
+        m_pos = start;
+        Fail("unexpected identifier '" + word + "'");
+      }
+    } else {
+      Fail("unexpected character");
+    }
+    return value;
+  }
+
+  const std::string& m_text;
+  std::string m_origin;
+  size_t m_pos;
+};
+
+Json5Value::Json5Value() : m_type(NUL), m_bool(false), m_number(0) {}
+
+Json5Value Json5Value::Parse(const std::string& text, const std::string& origin) {
+  return Json5Parser(text, origin).ParseDocument();
+}
+
+Json5Value Json5Value::Load(const std::string& path) {
+  std::ifstream in(path);
+  NS_ABORT_MSG_IF(!in, "cannot open " << path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return Parse(ss.str(), path);
+}
+
+bool Json5Value::AsBool() const {
+  NS_ABORT_MSG_IF(m_type != BOOL, "json5: value is not a boolean");
+  return m_bool;
+}
+
+double Json5Value::AsNumber() const {
+  NS_ABORT_MSG_IF(m_type != NUMBER, "json5: value is not a number");
+  return m_number;
+}
+
+int64_t Json5Value::AsInt() const {
+  double n = AsNumber();
+  NS_ABORT_MSG_IF(n != std::floor(n), "json5: expected an integer, got " << n);
+  return static_cast<int64_t>(n);
+}
+
+const std::string& Json5Value::AsString() const {
+  NS_ABORT_MSG_IF(m_type != STRING, "json5: value is not a string");
+  return m_string;
+}
+
+const std::vector<Json5Value>& Json5Value::Elements() const {
+  NS_ABORT_MSG_IF(m_type != ARRAY, "json5: value is not an array");
+  return m_elements;
+}
+
+const std::vector<std::pair<std::string, Json5Value>>& Json5Value::Members() const {
+  NS_ABORT_MSG_IF(m_type != OBJECT, "json5: value is not an object");
+  return m_members;
+}
+
+bool Json5Value::Has(const std::string& key) const {
+  return !Get(key).IsNull();
+}
+
+const Json5Value& Json5Value::Get(const std::string& key) const {
+  static const Json5Value null;
+  if (m_type == OBJECT) {
+    for (const auto& member : m_members) {
+      if (member.first == key) {
+        return member.second;
+      }
+    }
+  }
+  return null;
+}
+
+double Json5Value::GetNumber(const std::string& key, double defaultValue) const {
+  const Json5Value& v = Get(key);
+  return v.IsNull() ? defaultValue : v.AsNumber();
+}
+
+std::string Json5Value::GetString(const std::string& key, const std::string& defaultValue) const {
+  const Json5Value& v = Get(key);
+  return v.IsNull() ? defaultValue : v.AsString();
+}
+
+bool Json5Value::GetBool(const std::string& key, bool defaultValue) const {
+  const Json5Value& v = Get(key);
+  return v.IsNull() ? defaultValue : v.AsBool();
+}
+
+}  // namespace ns3
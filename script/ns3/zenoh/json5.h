@@ -0,0 +1,65 @@
+#ifndef ZENOH_SIM_JSON5_H
+#define ZENOH_SIM_JSON5_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Minimal JSON5 document model, just enough for NETWORK_CONFIG.json5 and the
+ * other json5 files kept next to it: comments, unquoted keys, single quoted
+ * strings and trailing commas. Object members keep their file order.
+ */
+class Json5Value {
+ public:
+  enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+
+  Json5Value();
+
+  /// Parses a whole document. Aborts with file/line information on error.
+  static Json5Value Parse(const std::string& text, const std::string& origin);
+  /// Reads and parses a file.
+  static Json5Value Load(const std::string& path);
+
+  Type GetType() const { return m_type; }
+  bool IsNull() const { return m_type == NUL; }
+  bool IsNumber() const { return m_type == NUMBER; }
+  bool IsString() const { return m_type == STRING; }
+  bool IsArray() const { return m_type == ARRAY; }
+  bool IsObject() const { return m_type == OBJECT; }
+
+  bool AsBool() const;
+  double AsNumber() const;
+  int64_t AsInt() const;
+  const std::string& AsString() const;
+
+  /// Array elements.
+  const std::vector<Json5Value>& Elements() const;
+  /// Object members, in file order.
+  const std::vector<std::pair<std::string, Json5Value>>& Members() const;
+
+  bool Has(const std::string& key) const;
+  /// Object member lookup; returns a null value when the key is absent.
+  const Json5Value& Get(const std::string& key) const;
+
+  double GetNumber(const std::string& key, double defaultValue) const;
+  std::string GetString(const std::string& key, const std::string& defaultValue) const;
+  bool GetBool(const std::string& key, bool defaultValue) const;
+
+ private:
+  friend class Json5Parser;
+
+  Type m_type;
+  bool m_bool;
+  double m_number;
+  std::string m_string;
+  std::vector<Json5Value> m_elements;
+  std::vector<std::pair<std::string, Json5Value>> m_members;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_JSON5_H
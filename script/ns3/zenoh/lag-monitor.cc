@@ -0,0 +1,214 @@
+#include "lag-monitor.h"
+
+#include "ns3/global-value.h"
+#include "ns3/log.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <chrono>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("LagMonitor");
+
+NS_OBJECT_ENSURE_REGISTERED(LagMonitorScheduler);
+
+LagMonitor* LagMonitorScheduler::s_monitor = nullptr;
+
+namespace {
+
+int64_t WallNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+TypeId LagMonitorScheduler::GetTypeId() {
+  static TypeId tid = TypeId("ns3::LagMonitorScheduler")
+                          .SetParent<Scheduler>()
+                          .AddConstructor<LagMonitorScheduler>();
+  return tid;
+}
+
+LagMonitorScheduler::LagMonitorScheduler() : m_inner(CreateObject<MapScheduler>()) {}
+
+void LagMonitorScheduler::Insert(const Event& ev) {
+  m_inner->Insert(ev);
+}
+
+bool LagMonitorScheduler::IsEmpty() const {
+  return m_inner->IsEmpty();
+}
+
+Scheduler::Event LagMonitorScheduler::PeekNext() const {
+  return m_inner->PeekNext();
+}
+
+Scheduler::Event LagMonitorScheduler::RemoveNext() {
+  Event ev = m_inner->RemoveNext();
+  if (s_monitor) {
+    s_monitor->RecordEvent(ev.key.m_ts, ev.key.m_context);
+  }
+  return ev;
+}
+
+void LagMonitorScheduler::Remove(const Event& ev) {
+  m_inner->Remove(ev);
+}
+
+void LagMonitor::UseLagMonitorScheduler() {
+  GlobalValue::Bind("SchedulerType", StringValue("ns3::LagMonitorScheduler"));
+}
+
+LagMonitor::LagMonitor(EmulatedTopology& topology, const std::string& outputDir)
+    : m_topology(topology),
+      m_outputDir(outputDir),
+      m_reportInterval(Seconds(1)),
+      m_thresholdNs(0),
+      m_abortRun(false),
+      m_running(false),
+      m_originSet(false),
+      m_originNs(0),
+      m_measureFromNs(std::numeric_limits<int64_t>::max()),
+      m_exceeded(false),
+      m_aborted(false),
+      m_overThreshold(0),
+      m_perContext(topology.GetNodes().GetN() + 1) {}
+
+LagMonitor::~LagMonitor() {
+  if (LagMonitorScheduler::s_monitor == this) {
+    LagMonitorScheduler::s_monitor = nullptr;
+  }
+}
+
+void LagMonitor::SetThreshold(Time threshold, bool abortRun) {
+  m_thresholdNs = threshold.GetNanoSeconds();
+  m_abortRun = abortRun;
+}
+
+void LagMonitor::SetReportInterval(Time interval) {
+  m_reportInterval = interval;
+}
+
+void LagMonitor::Start() {
+  m_stream.open(m_outputDir + "/lag.csv");
+  m_stream << "sim_s,wall_s,events,p50_us,p99_us,max_us,over_threshold\n";
+  LagMonitorScheduler::s_monitor = this;
+  m_running = true;
+  Simulator::Schedule(m_reportInterval, &LagMonitor::Report, this);
+}
+
+void LagMonitor::RecordEvent(uint64_t ts, uint32_t context) {
+  if (!m_running) {
+    return;
+  }
+  int64_t now = WallNs();
+  if (!m_originSet) {
+    // The first event runs as soon as Run() starts; anchor wall time there.
+    m_originNs = now - static_cast<int64_t>(ts);
+    m_originSet = true;
+  }
+  if (static_cast<int64_t>(ts) < m_measureFromNs) {
+    return;
+  }
+  int64_t late = now - m_originNs - static_cast<int64_t>(ts);
+  uint64_t lateNs = late > 0 ? static_cast<uint64_t>(late) : 0;
+
+  m_total.Add(lateNs);
+  m_window.Add(lateNs);
+  m_perContext[context < m_perContext.size() - 1 ? context : m_perContext.size() - 1].Add(lateNs);
+
+  if (m_thresholdNs && lateNs > m_thresholdNs) {
+    if (!m_exceeded) {
+      m_exceeded = true;
+      m_firstExceeded = TimeStep(ts);
+    }
+    ++m_overThreshold;
+  }
+}
+
+void LagMonitor::MeasureFromNow() {
+  // Everything due up to this wall-clock moment queued up behind the attaches.
+  m_measureFromNs = m_originSet ? WallNs() - m_originNs : 0;
+  NS_LOG_UNCOND("lag monitor: measuring events due after " << m_measureFromNs / 1e9 << " s");
+}
+
+void LagMonitor::Report() {
+  double wall = m_originSet ? (WallNs() - m_originNs) / 1e9 : 0;
+  m_stream << Simulator::Now().GetSeconds() << "," << wall << "," << m_window.Count() << ","
+           << m_window.Percentile(0.5) / 1e3 << "," << m_window.Percentile(0.99) / 1e3 << ","
+           << m_window.Max() / 1e3 << "," << m_overThreshold << std::endl;
+  m_window.Reset();
+
+  if (m_exceeded && m_abortRun) {
+    NS_LOG_UNCOND("lag monitor: events ran more than " << m_thresholdNs / 1e6
+                                                       << " ms late, stopping the run at "
+                                                       << Simulator::Now().GetSeconds() << " s");
+    m_aborted = true;
+    Simulator::Stop();
+    return;
+  }
+  Simulator::Schedule(m_reportInterval, &LagMonitor::Report, this);
+}
+
+void LagMonitor::WriteHistogram(std::ostream& os, const LogHistogram& h) {
+  os << "\"events\": " << h.Count() << ", \"p50_us\": " << h.Percentile(0.5) / 1e3
+     << ", \"p99_us\": " << h.Percentile(0.99) / 1e3 << ", \"max_us\": " << h.Max() / 1e3;
+}
+
+void LagMonitor::Finish() {
+  m_running = false;
+  LagMonitorScheduler::s_monitor = nullptr;
+  m_stream.close();
+
+  // Node context -> TAPs on that node, for the per-context breakdown.
+  std::vector<std::vector<std::string>> taps(m_perContext.size());
+  for (const auto& link : m_topology.GetLinks()) {
+    for (const auto& end : link.ends) {
+      taps[end.node->GetId()].push_back(end.tapName);
+    }
+  }
+
+  std::ofstream os(m_outputDir + "/lag_summary.json");
+  os << "{\n  \"threshold_ms\": " << m_thresholdNs / 1e6
+     << ",\n  \"flagged\": " << (m_exceeded ? "true" : "false")
+     << ",\n  \"aborted\": " << (m_aborted ? "true" : "false")
+     << ",\n  \"events_over_threshold\": " << m_overThreshold;
+  if (m_exceeded) {
+    os << ",\n  \"first_over_threshold_s\": " << m_firstExceeded.GetSeconds();
+  }
+  os << ",\n  \"total\": {";
+  WriteHistogram(os, m_total);
+  os << "},\n  \"contexts\": [";
+  const char* sep = "\n";
+  for (uint32_t i = 0; i < m_perContext.size(); ++i) {
+    if (m_perContext[i].Count() == 0) {
+      continue;
+    }
+    os << sep << "    {";
+    if (i + 1 < m_perContext.size()) {
+      os << "\"node\": \"" << m_topology.GetConfig().nodes[i].id << "\", \"taps\": [";
+      for (uint32_t t = 0; t < taps[i].size(); ++t) {
+        os << (t ? ", " : "") << "\"" << taps[i][t] << "\"";
+      }
+      os << "], ";
+    } else {
+      os << "\"node\": null, ";
+    }
+    WriteHistogram(os, m_perContext[i]);
+    os << "}";
+    sep = ",\n";
+  }
+  os << "\n  ]\n}\n";
+
+  NS_LOG_UNCOND("lag: events=" << m_total.Count() << " p50=" << m_total.Percentile(0.5) / 1e3
+                               << "us p99=" << m_total.Percentile(0.99) / 1e3
+                               << "us max=" << m_total.Max() / 1e3 << "us"
+                               << (m_exceeded ? " FLAGGED: over threshold" : ""));
+}
+
+}  // namespace ns3
@@ -0,0 +1,106 @@
+#ifndef ZENOH_SIM_LAG_MONITOR_H
+#define ZENOH_SIM_LAG_MONITOR_H
+
+#include "emulated-topology.h"
+#include "log-histogram.h"
+
+#include "ns3/nstime.h"
+#include "ns3/scheduler.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class LagMonitor;
+
+/**
+ * Scheduler wrapper that reports, for every event the real-time simulator
+ * takes off the queue, how late it is against the wall clock.
+ *
+ * RealtimeSimulatorImpl only removes an event once its timestamp is due, so
+ * removal time minus due time is exactly the lateness of that event. The
+ * actual ordering is delegated to a MapScheduler (the ns-3 default).
+ */
+class LagMonitorScheduler : public Scheduler {
+ public:
+  static TypeId GetTypeId();
+
+  LagMonitorScheduler();
+
+  void Insert(const Event& ev) override;
+  bool IsEmpty() const override;
+  Event PeekNext() const override;
+  Event RemoveNext() override;
+  void Remove(const Event& ev) override;
+
+ private:
+  friend class LagMonitor;
+  static LagMonitor* s_monitor;
+
+  Ptr<Scheduler> m_inner;
+};
+
+/**
+ * Collects per-event real-time lateness, keyed by event context (the ns-3
+ * node id, i.e. the TAPs of one container). Streams one line per report
+ * interval to lag.csv, writes lag_summary.json at the end, and flags or
+ * stops the run when an event is later than the threshold.
+ *
+ * Events due before MeasureFromNow are left out: at startup the TAP bridges
+ * attach one after the other at time 0, and everything due meanwhile runs
+ * late by the attach time, not because the loop cannot keep up.
+ */
+class LagMonitor {
+ public:
+  /// Must be called before anything touches the simulator.
+  static void UseLagMonitorScheduler();
+
+  LagMonitor(EmulatedTopology& topology, const std::string& outputDir);
+  ~LagMonitor();
+
+  /// 0 disables the threshold.
+  void SetThreshold(Time threshold, bool abortRun);
+  void SetReportInterval(Time interval);
+
+  void Start();
+  /// Records the events due from now on; call once every TAP is attached.
+  void MeasureFromNow();
+  /// Stops recording (Simulator::Destroy drains the queue) and writes the summary.
+  void Finish();
+
+  bool Exceeded() const { return m_exceeded; }
+  bool Aborted() const { return m_aborted; }
+
+  /// Called from LagMonitorScheduler::RemoveNext, under the simulator lock.
+  void RecordEvent(uint64_t ts, uint32_t context);
+
+ private:
+  void Report();
+  static void WriteHistogram(std::ostream& os, const LogHistogram& h);
+
+  EmulatedTopology& m_topology;
+  std::string m_outputDir;
+  std::ofstream m_stream;
+  Time m_reportInterval;
+  uint64_t m_thresholdNs;
+  bool m_abortRun;
+
+  bool m_running;
+  bool m_originSet;
+  int64_t m_originNs;
+  int64_t m_measureFromNs;  ///< simulation ns of the first event recorded
+  bool m_exceeded;
+  bool m_aborted;
+  uint64_t m_overThreshold;
+  Time m_firstExceeded;
+
+  LogHistogram m_total;
+  LogHistogram m_window;  ///< since the last report
+  std::vector<LogHistogram> m_perContext;  ///< last slot: events without a node context
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_LAG_MONITOR_H
@@ -0,0 +1,450 @@
+#include "latency-probe.h"
+
+#include "ns3/callback.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/queue.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("LatencyProbe");
+
+namespace {
+
+double Ms(double ns) {
+  return ns / 1e6;
+}
+
+bool Listed(const std::vector<std::string>& taps, const std::string& tap) {
+  return std::find(taps.begin(), taps.end(), tap) != taps.end();
+}
+
+}  // namespace
+
+LatencyProbe::LatencyProbe(EmulatedTopology& topology, const std::string& outputDir)
+    : m_topology(topology),
+      m_outputDir(outputDir),
+      m_fpBytes(64),
+      m_horizon(Seconds(30)),
+      m_nRecords(16384),
+      m_started(false),
+      m_parser(2 * topology.GetLinks().size(), 1024, 1024),
+      m_currentUid(0),
+      m_opened(0),
+      m_samples(0),
+      m_ambiguous(0),
+      m_undelivered(0),
+      m_tableFull(0),
+      m_unknown(0) {}
+
+void LatencyProbe::SetFingerprintBytes(uint32_t bytes) {
+  m_fpBytes = bytes;
+}
+
+void LatencyProbe::SetHorizon(Time horizon) {
+  m_horizon = horizon;
+}
+
+void LatencyProbe::SetRecords(uint32_t records) {
+  m_nRecords = std::max<uint32_t>(records, kProbes);
+}
+
+void LatencyProbe::SetIngress(const std::vector<std::string>& taps) {
+  m_ingressTaps = taps;
+}
+
+void LatencyProbe::SetEgress(const std::vector<std::string>& taps) {
+  m_egressTaps = taps;
+}
+
+void LatencyProbe::Start() {
+  const NetworkConfig& config = m_topology.GetConfig();
+  auto role = [&config](const std::string& id) -> const std::string& {
+    return config.nodes[config.NodeIndex(id)].role;
+  };
+
+  uint32_t n = m_parser.GetNDirections();
+  m_frame.assign(65536, 0);
+  m_directions.assign(n, Direction());
+  m_records.assign(m_nRecords, Record());
+  m_flows.reserve(kMaxFlows);
+  m_path.reserve(kMaxHops);
+  m_parser.SetPayloadCallback(m_fpBytes, [this](uint32_t dir, uint16_t key, uint64_t fp) {
+    OnPayload(dir, key, fp);
+  });
+
+  uint32_t ingress = 0;
+  uint32_t egress = 0;
+  for (uint32_t i = 0; i < n; ++i) {
+    Direction& dir = m_directions[i];
+    const LinkEndpoint& from = Sender(i);
+    const LinkEndpoint& to = Receiver(i);
+    dir.probe = this;
+    dir.index = i;
+    dir.ingress = m_ingressTaps.empty() ? role(from.nodeId) == "pub"
+                                        : Listed(m_ingressTaps, from.tapName);
+    dir.egress = m_egressTaps.empty() ? role(to.nodeId) == "sub" : Listed(m_egressTaps, to.tapName);
+    ingress += dir.ingress;
+    egress += dir.egress;
+
+    from.device->TraceConnectWithoutContext("MacTx",
+                                            MakeBoundCallback(&LatencyProbe::OnTx, &dir));
+    PointerValue queue;
+    from.device->GetAttribute("TxQueue", queue);
+    queue.Get<Queue<Packet>>()->TraceConnectWithoutContext(
+        "Dequeue", MakeBoundCallback(&LatencyProbe::OnDequeue, &dir));
+    to.device->TraceConnectWithoutContext("MacPromiscRx",
+                                          MakeBoundCallback(&LatencyProbe::OnRx, &dir));
+  }
+  if (ingress == 0 || egress == 0) {
+    NS_LOG_UNCOND("latency: no " << (ingress == 0 ? "ingress" : "egress")
+                                 << " link end, set node roles or --latencyIngress/Egress");
+  }
+
+  m_samplesCsv.open(m_outputDir + "/latency_samples.csv");
+  m_samplesCsv << "id,sim_s,key,pub_tap,sub_tap,latency_ms,node_ms,queue_ms,wire_ms,hops,"
+                  "complete\n";
+  m_hopsCsv.open(m_outputDir + "/latency_hops.csv");
+  m_hopsCsv << "id,hop,link,from,to,node_ms,queue_ms,wire_ms\n";
+  m_started = true;
+}
+
+void LatencyProbe::OnTx(Direction* dir, Ptr<const Packet> packet) {
+  // Same capture as PathObserver: headers only, unless a fingerprint ends in this frame.
+  LatencyProbe* self = dir->probe;
+  uint32_t size = packet->GetSize();
+  self->m_currentUid = packet->GetUid();
+  uint32_t captured = packet->CopyData(self->m_frame.data(), std::min(size, kCapture));
+  if (!self->m_parser.OnFrame(dir->index, self->m_frame.data(), captured, size)) {
+    captured = packet->CopyData(self->m_frame.data(),
+                                std::min<uint32_t>(size, self->m_frame.size()));
+    self->m_parser.OnFrame(dir->index, self->m_frame.data(), captured, captured);
+  }
+}
+
+void LatencyProbe::OnPayload(uint32_t dirIndex, uint16_t key, uint64_t fingerprint) {
+  fingerprint = fingerprint ? fingerprint : 1;  // 0 marks a free record
+  Direction& dir = m_directions[dirIndex];
+  int64_t now = Simulator::Now().GetNanoSeconds();
+
+  uint32_t index = Lookup(fingerprint);
+  if (index == kNone) {
+    if (!dir.ingress) {
+      ++m_unknown;
+      return;
+    }
+    index = Claim(fingerprint);
+    if (index == kNone) {
+      ++m_tableFull;
+      return;
+    }
+    Record& record = m_records[index];
+    record.fingerprint = fingerprint;
+    record.ingressNs = now;
+    record.key = key;
+    record.ingressDir = dirIndex;
+    record.ambiguous = false;
+    record.delivered = 0;
+    record.nHops = 1;
+    record.hops[0] = Hop{dirIndex, now, -1, -1};
+    ++m_opened;
+    Track(dir, index, 0);
+    return;
+  }
+
+  Record& record = m_records[index];
+  if (record.ambiguous) {
+    return;
+  }
+  for (uint32_t h = 0; h < record.nHops; ++h) {
+    if (record.hops[h].dir == dirIndex) {
+      // Twice over the same link: a second put with the same payload prefix.
+      if (dir.ingress) {
+        record.ambiguous = true;
+        ++m_ambiguous;
+      }
+      return;
+    }
+  }
+  if (record.nHops == kMaxHops) {
+    return;
+  }
+  record.hops[record.nHops] = Hop{dirIndex, now, -1, -1};
+  Track(dir, index, record.nHops++);
+}
+
+void LatencyProbe::Track(Direction& dir, uint32_t record, uint32_t hop) {
+  InFlight& slot = dir.inFlight[dir.next];
+  dir.active += slot.fingerprint == 0;
+  slot = InFlight{m_currentUid, m_records[record].fingerprint, record, hop};
+  dir.next = (dir.next + 1) % kInFlight;
+}
+
+void LatencyProbe::OnDequeue(Direction* dir, Ptr<const Packet> packet) {
+  if (dir->active == 0) {
+    return;
+  }
+  LatencyProbe* self = dir->probe;
+  uint64_t uid = packet->GetUid();
+  for (const InFlight& frame : dir->inFlight) {
+    if (frame.fingerprint == 0 || frame.uid != uid) {
+      continue;
+    }
+    Record& record = self->m_records[frame.record];
+    if (record.fingerprint == frame.fingerprint) {
+      Hop& hop = record.hops[frame.hop];
+      hop.queueNs = Simulator::Now().GetNanoSeconds() - hop.inNs;
+    }
+  }
+}
+
+void LatencyProbe::OnRx(Direction* dir, Ptr<const Packet> packet) {
+  if (dir->active == 0) {
+    return;
+  }
+  LatencyProbe* self = dir->probe;
+  uint64_t uid = packet->GetUid();
+  for (InFlight& frame : dir->inFlight) {
+    if (frame.fingerprint == 0 || frame.uid != uid) {
+      continue;
+    }
+    Record& record = self->m_records[frame.record];
+    if (record.fingerprint == frame.fingerprint) {
+      record.hops[frame.hop].outNs = Simulator::Now().GetNanoSeconds();
+      if (dir->egress) {
+        self->Emit(record, frame.hop);
+      }
+    }
+    frame.fingerprint = 0;
+    --dir->active;
+  }
+}
+
+void LatencyProbe::Emit(Record& record, uint32_t hop) {
+  if (record.ambiguous) {
+    return;
+  }
+  // Walk back from the egress hop: the hop before is the latest one that
+  // arrived at this hop's sender before this hop left it.
+  m_path.clear();
+  uint32_t cur = hop;
+  m_path.push_back(cur);
+  while (record.hops[cur].dir != record.ingressDir && m_path.size() < record.nHops) {
+    const std::string& node = Sender(record.hops[cur].dir).nodeId;
+    uint32_t prev = kNone;
+    for (uint32_t h = 0; h < record.nHops; ++h) {
+      const Hop& candidate = record.hops[h];
+      if (candidate.outNs >= 0 && candidate.outNs <= record.hops[cur].inNs &&
+          Receiver(candidate.dir).nodeId == node &&
+          (prev == kNone || candidate.outNs > record.hops[prev].outNs)) {
+        prev = h;
+      }
+    }
+    if (prev == kNone) {
+      break;
+    }
+    cur = prev;
+    m_path.push_back(cur);
+  }
+  std::reverse(m_path.begin(), m_path.end());
+  bool complete = record.hops[cur].dir == record.ingressDir;
+
+  ++record.delivered;
+  uint64_t id = m_samples++;
+  const Hop& last = record.hops[hop];
+  int64_t latency = last.outNs - record.ingressNs;
+  int64_t nodeNs = 0;
+  int64_t queueNs = 0;
+  int64_t wireNs = 0;
+  int64_t prevOut = record.ingressNs;
+  Flow* flow = GetFlow(record.key, record.ingressDir, last.dir);
+  for (uint32_t i = 0; i < m_path.size(); ++i) {
+    const Hop& h = record.hops[m_path[i]];
+    int64_t node = i == 0 ? 0 : h.inNs - prevOut;
+    int64_t queue = std::max<int64_t>(h.queueNs, 0);
+    int64_t wire = h.outNs - h.inNs - queue;
+    prevOut = h.outNs;
+    nodeNs += node;
+    queueNs += queue;
+    wireNs += wire;
+
+    const EmulatedLink& link = Link(h.dir);
+    m_hopsCsv << id << "," << i << "," << link.name << "," << Sender(h.dir).nodeId << ","
+              << Receiver(h.dir).nodeId << "," << Ms(node) << "," << Ms(queue) << ","
+              << Ms(wire) << "\n";
+    if (complete && flow) {
+      HopStats& stats = flow->hops[h.dir];
+      ++stats.samples;
+      stats.nodeNs += node;
+      stats.queueNs += queue;
+      stats.wireNs += wire;
+      stats.queueMaxNs = std::max(stats.queueMaxNs, queue);
+    }
+  }
+  m_samplesCsv << id << "," << Simulator::Now().GetSeconds() << "," << m_parser.GetKey(record.key)
+               << "," << Sender(record.ingressDir).tapName << "," << Receiver(last.dir).tapName
+               << "," << Ms(latency) << "," << Ms(nodeNs) << "," << Ms(queueNs) << ","
+               << Ms(wireNs) << "," << m_path.size() << "," << complete << "\n";
+
+  if (flow) {
+    flow->latency.Add(std::max<int64_t>(latency, 0));
+    if (complete) {
+      ++flow->complete;
+      flow->node.Add(std::max<int64_t>(nodeNs, 0));
+      flow->queue.Add(queueNs);
+    }
+  }
+}
+
+LatencyProbe::Flow* LatencyProbe::GetFlow(uint16_t key, uint32_t ingressDir, uint32_t egressDir) {
+  for (Flow& flow : m_flows) {
+    if (flow.key == key && flow.ingressDir == ingressDir && flow.egressDir == egressDir) {
+      return &flow;
+    }
+  }
+  if (m_flows.size() == kMaxFlows) {
+    return nullptr;
+  }
+  m_flows.emplace_back();
+  Flow& flow = m_flows.back();
+  flow.key = key;
+  flow.ingressDir = ingressDir;
+  flow.egressDir = egressDir;
+  flow.complete = 0;
+  flow.hops.resize(m_directions.size());
+  return &flow;
+}
+
+bool LatencyProbe::Expired(const Record& record) const {
+  return Simulator::Now().GetNanoSeconds() - record.ingressNs > m_horizon.GetNanoSeconds();
+}
+
+void LatencyProbe::Expire(Record& record) {
+  if (!record.ambiguous && record.delivered == 0) {
+    ++m_undelivered;
+  }
+  record.fingerprint = 0;
+}
+
+uint32_t LatencyProbe::Lookup(uint64_t fingerprint) {
+  uint32_t n = m_records.size();
+  for (uint32_t i = 0; i < kProbes; ++i) {
+    uint32_t index = (fingerprint % n + i) % n;
+    Record& record = m_records[index];
+    if (record.fingerprint != fingerprint) {
+      continue;
+    }
+    if (!Expired(record)) {
+      return index;
+    }
+    Expire(record);
+  }
+  return kNone;
+}
+
+uint32_t LatencyProbe::Claim(uint64_t fingerprint) {
+  // A free or expired slot first, else the oldest record already delivered
+  // once: later subscribers of it are lost, but the table keeps up.
+  uint32_t n = m_records.size();
+  uint32_t victim = kNone;
+  for (uint32_t i = 0; i < kProbes; ++i) {
+    uint32_t index = (fingerprint % n + i) % n;
+    Record& record = m_records[index];
+    if (record.fingerprint == 0) {
+      return index;
+    }
+    if (Expired(record)) {
+      Expire(record);
+      return index;
+    }
+    if (record.delivered > 0 &&
+        (victim == kNone || record.ingressNs < m_records[victim].ingressNs)) {
+      victim = index;
+    }
+  }
+  if (victim != kNone) {
+    Expire(m_records[victim]);
+  }
+  return victim;
+}
+
+void LatencyProbe::Finish() {
+  if (!m_started) {
+    return;
+  }
+  for (Record& record : m_records) {
+    if (record.fingerprint != 0) {
+      Expire(record);
+    }
+  }
+  m_samplesCsv.close();
+  m_hopsCsv.close();
+
+  std::ofstream hist(m_outputDir + "/latency_hist.csv");
+  hist << "key,pub_tap,sub_tap,upper_ms,count\n";
+  for (const Flow& flow : m_flows) {
+    for (uint32_t b = 0; b < LogHistogram::kBuckets; ++b) {
+      if (flow.latency.BucketCount(b) > 0) {
+        hist << m_parser.GetKey(flow.key) << "," << Sender(flow.ingressDir).tapName << ","
+             << Receiver(flow.egressDir).tapName << "," << Ms(LogHistogram::BucketUpper(b))
+             << "," << flow.latency.BucketCount(b) << "\n";
+      }
+    }
+  }
+
+  const ZenohFlowParser::Stats& stats = m_parser.GetStats();
+  std::ofstream os(m_outputDir + "/latency_summary.json");
+  os << "{\n  \"fingerprint_bytes\": " << m_fpBytes << ",\n  \"opened\": " << m_opened
+     << ",\n  \"samples\": " << m_samples << ",\n  \"ambiguous\": " << m_ambiguous
+     << ",\n  \"undelivered\": " << m_undelivered << ",\n  \"table_full\": " << m_tableFull
+     << ",\n  \"unknown\": " << m_unknown << ",\n  \"parser\": {\"frames\": " << stats.frames
+     << ", \"streams\": " << stats.streams << ", \"resyncs\": " << stats.resyncs
+     << ", \"unparsed_bytes\": " << stats.unparsedBytes
+     << ", \"stream_table_full\": " << stats.streamTableFull << "},\n  \"flows\": [";
+  const char* sep = "\n";
+  std::vector<uint32_t> order;
+  for (const Flow& flow : m_flows) {
+    os << sep << "    {\"key\": \"" << m_parser.GetKey(flow.key) << "\", \"pub_tap\": \""
+       << Sender(flow.ingressDir).tapName << "\", \"sub_tap\": \""
+       << Receiver(flow.egressDir).tapName << "\", \"samples\": " << flow.latency.Count()
+       << ", \"complete\": " << flow.complete << ",\n     \"latency_ms\": {\"mean\": "
+       << Ms(flow.latency.Mean()) << ", \"p50\": " << Ms(flow.latency.Percentile(0.5))
+       << ", \"p99\": " << Ms(flow.latency.Percentile(0.99))
+       << ", \"max\": " << Ms(flow.latency.Max()) << "}, \"node_ms\": {\"mean\": "
+       << Ms(flow.node.Mean()) << ", \"p99\": " << Ms(flow.node.Percentile(0.99))
+       << "}, \"queue_ms\": {\"mean\": " << Ms(flow.queue.Mean())
+       << ", \"p99\": " << Ms(flow.queue.Percentile(0.99)) << "},\n     \"hops\": [";
+    order.clear();
+    for (uint32_t dir = 0; dir < flow.hops.size(); ++dir) {
+      if (flow.hops[dir].samples > 0) {
+        order.push_back(dir);
+      }
+    }
+    std::sort(order.begin(), order.end(), [&flow](uint32_t a, uint32_t b) {
+      return flow.hops[a].samples > flow.hops[b].samples;
+    });
+    const char* inner = "";
+    for (uint32_t dir : order) {
+      const HopStats& hop = flow.hops[dir];
+      os << inner << "{\"link\": \"" << Link(dir).name << ":" << Sender(dir).nodeId << ">"
+         << Receiver(dir).nodeId << "\", \"samples\": " << hop.samples
+         << ", \"node_ms\": " << Ms(hop.nodeNs / hop.samples)
+         << ", \"queue_ms\": " << Ms(hop.queueNs / hop.samples)
+         << ", \"queue_max_ms\": " << Ms(hop.queueMaxNs)
+         << ", \"wire_ms\": " << Ms(hop.wireNs / hop.samples) << "}";
+      inner = ", ";
+    }
+    os << "]}";
+    sep = ",\n";
+  }
+  os << "\n  ]\n}\n";
+
+  NS_LOG_UNCOND("latency: " << m_samples << " samples over " << m_flows.size() << " flows, "
+                            << m_opened << " puts, " << m_ambiguous << " ambiguous, "
+                            << m_undelivered << " undelivered");
+}
+
+}  // namespace ns3
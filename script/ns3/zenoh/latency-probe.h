@@ -0,0 +1,171 @@
+#ifndef ZENOH_SIM_LATENCY_PROBE_H
+#define ZENOH_SIM_LATENCY_PROBE_H
+
+#include "emulated-topology.h"
+#include "log-histogram.h"
+#include "zenoh-flow-parser.h"
+
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * One-way latency of every publication, from the publisher's TAP to the
+ * subscriber's TAP, on the simulator clock. The probe also splits that time
+ * per hop.
+ *
+ * Every frame handed to a link (MacTx) goes through a ZenohFlowParser that
+ * fingerprints PUT payloads. A fingerprint seen on an ingress direction
+ * (leaving a pub node, or --latencyIngress) opens a record. Every later
+ * sighting on another link direction adds a hop, with the frame's entry
+ * time. The device queue's Dequeue trace and the peer's receive trace
+ * complete the hop with its queue and wire (transmission + propagation)
+ * time. Both are found through the packet uid. When a hop reaches an egress
+ * end (a sub node, or --latencyEgress), the record yields a sample. Its path
+ * is traced back hop by hop to the ingress. Time between two hops is spent
+ * inside the node in between, i.e. in zenohd's queues and the host.
+ *
+ * Samples are streamed to latency_samples.csv, with their hops in
+ * latency_hops.csv. At the end, latency_hist.csv holds the one-way latency
+ * histogram of every flow (key, ingress, egress), and latency_summary.json
+ * holds percentiles and the mean breakdown per flow and link direction.
+ *
+ * Memory is fixed at Start: a table of open records that expire after
+ * `horizon` (a full table reuses the oldest record already delivered), and
+ * a bounded list of frames in flight per direction. A
+ * fingerprint seen twice at ingress within the horizon (identical payload
+ * prefixes) is discarded as ambiguous; raise --latencyBytes then.
+ */
+class LatencyProbe {
+ public:
+  LatencyProbe(EmulatedTopology& topology, const std::string& outputDir);
+
+  /// Payload bytes hashed per put (default 64, 0: the whole payload).
+  void SetFingerprintBytes(uint32_t bytes);
+  /// How long a record waits for its subscribers (default 30 s).
+  void SetHorizon(Time horizon);
+  /// Open records kept at the same time (default 16384).
+  void SetRecords(uint32_t records);
+  /// TAPs where puts enter and leave; empty: the link ends of pub and sub nodes.
+  void SetIngress(const std::vector<std::string>& taps);
+  void SetEgress(const std::vector<std::string>& taps);
+
+  /// Hooks every link end; call after the topology is built.
+  void Start();
+  void Finish();
+
+ private:
+  static constexpr uint32_t kMaxHops = 16;
+  static constexpr uint32_t kInFlight = 64;  ///< fingerprinted frames tracked per direction
+  static constexpr uint32_t kMaxFlows = 256;
+  static constexpr uint32_t kProbes = 8;  ///< table slots tried per fingerprint
+  static constexpr uint32_t kCapture = 128;
+  static constexpr uint32_t kNone = ~0u;
+
+  struct Hop {
+    uint32_t dir;
+    int64_t inNs;     ///< frame handed to the sending device
+    int64_t queueNs;  ///< -1 until the frame leaves the device queue
+    int64_t outNs;    ///< -1 until the frame arrives at the peer
+  };
+
+  struct Record {
+    uint64_t fingerprint;  ///< 0: free
+    int64_t ingressNs;
+    uint16_t key;
+    uint32_t ingressDir;
+    bool ambiguous;
+    uint32_t delivered;
+    uint32_t nHops;
+    Hop hops[kMaxHops];
+  };
+
+  struct InFlight {
+    uint64_t uid;
+    uint64_t fingerprint;
+    uint32_t record;
+    uint32_t hop;
+  };
+
+  struct Direction {
+    LatencyProbe* probe;
+    uint32_t index;
+    bool ingress;
+    bool egress;
+    uint32_t active;  ///< slots of `inFlight` in use
+    uint32_t next;    ///< next slot of `inFlight` to overwrite
+    InFlight inFlight[kInFlight];
+  };
+
+  /// Totals of one flow over one link direction.
+  struct HopStats {
+    uint64_t samples = 0;
+    double nodeNs = 0;
+    double queueNs = 0;
+    double wireNs = 0;
+    int64_t queueMaxNs = 0;
+  };
+
+  struct Flow {
+    uint16_t key;
+    uint32_t ingressDir;
+    uint32_t egressDir;
+    uint64_t complete;
+    LogHistogram latency;
+    LogHistogram node;   ///< sum of the time spent inside nodes
+    LogHistogram queue;  ///< sum of the device queue times
+    std::vector<HopStats> hops;  ///< [direction]
+  };
+
+  static void OnTx(Direction* dir, Ptr<const Packet> packet);
+  static void OnDequeue(Direction* dir, Ptr<const Packet> packet);
+  static void OnRx(Direction* dir, Ptr<const Packet> packet);
+  void OnPayload(uint32_t dir, uint16_t key, uint64_t fingerprint);
+  void Track(Direction& dir, uint32_t record, uint32_t hop);
+  uint32_t Lookup(uint64_t fingerprint);
+  uint32_t Claim(uint64_t fingerprint);
+  bool Expired(const Record& record) const;
+  void Expire(Record& record);
+  void Emit(Record& record, uint32_t hop);
+  Flow* GetFlow(uint16_t key, uint32_t ingressDir, uint32_t egressDir);
+
+  const EmulatedLink& Link(uint32_t dir) const { return m_topology.GetLinks()[dir / 2]; }
+  const LinkEndpoint& Sender(uint32_t dir) const { return Link(dir).ends[dir % 2]; }
+  const LinkEndpoint& Receiver(uint32_t dir) const { return Link(dir).ends[1 - dir % 2]; }
+
+  EmulatedTopology& m_topology;
+  std::string m_outputDir;
+  uint32_t m_fpBytes;
+  Time m_horizon;
+  uint32_t m_nRecords;
+  std::vector<std::string> m_ingressTaps;
+  std::vector<std::string> m_egressTaps;
+  bool m_started;
+
+  ZenohFlowParser m_parser;
+  std::vector<uint8_t> m_frame;
+  std::vector<Direction> m_directions;
+  std::vector<Record> m_records;
+  std::vector<Flow> m_flows;
+  std::vector<uint32_t> m_path;
+  uint64_t m_currentUid;  ///< frame being parsed
+
+  uint64_t m_opened;
+  uint64_t m_samples;
+  uint64_t m_ambiguous;
+  uint64_t m_undelivered;
+  uint64_t m_tableFull;
+  uint64_t m_unknown;  ///< fingerprints away from ingress without a record
+
+  std::ofstream m_samplesCsv;
+  std::ofstream m_hopsCsv;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_LATENCY_PROBE_H
@@ -0,0 +1,204 @@
+#include "link-qos.h"
+
+#include "p2p-ethernet-net-device.h"
+
+#include "ns3/abort.h"
+#include "ns3/csma-net-device.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("LinkQos");
+
+namespace {
+
+std::vector<std::string> Split(const std::string& list, char sep) {
+  std::vector<std::string> items;
+  std::istringstream is(list);
+  std::string item;
+  while (std::getline(is, item, sep)) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+double Number(const std::string& s, const std::string& what) {
+  char* end = nullptr;
+  double v = std::strtod(s.c_str(), &end);
+  NS_ABORT_MSG_IF(s.empty() || *end != '\0' || v < 0, what << ": bad value `" << s << "`");
+  return v;
+}
+
+double Ms(double ns) {
+  return ns / 1e6;
+}
+
+/// Ethernet header, VLAN tag and FCS around an MTU-sized payload.
+const uint32_t kFrameOverhead = 22;
+
+}  // namespace
+
+LinkQos::LinkQos(EmulatedTopology& topology, const std::string& outputDir)
+    : m_topology(topology), m_outputDir(outputDir) {
+  m_params.weights = {0, 4, 1};
+}
+
+void LinkQos::SetClassifier(PriorityQueueParams::Classifier classifier) {
+  m_params.classifier = classifier;
+}
+
+void LinkQos::SetClasses(const std::string& classes) {
+  m_params.weights.clear();
+  for (const std::string& item : Split(classes, ',')) {
+    m_params.weights.push_back(item == "sp" ? 0 : Number(item, "--qosClasses"));
+    NS_ABORT_MSG_IF(item != "sp" && m_params.weights.back() == 0,
+                    "--qosClasses: weights must be positive, strict priority is `sp`");
+  }
+  NS_ABORT_MSG_IF(m_params.weights.empty(), "--qosClasses needs at least one class");
+}
+
+void LinkQos::SetMap(const std::string& map) {
+  m_map = map;
+}
+
+void LinkQos::SetRates(const std::string& rates) {
+  m_rates.clear();
+  for (const std::string& item : Split(rates, ',')) {
+    m_rates.push_back(Number(item, "--qosRate"));
+  }
+}
+
+void LinkQos::SetBurst(uint32_t bytes) {
+  m_params.burstBytes = bytes;
+}
+
+void LinkQos::SetQueueLimit(uint32_t bytes) {
+  m_params.limitBytes = bytes;
+}
+
+void LinkQos::Start() {
+  bool dscp = m_params.classifier == PriorityQueueParams::DSCP;
+  for (uint32_t v = 0; v < 64; ++v) {
+    m_params.dscpClass[v] = v >= 40 ? 0 : v >= 16 ? 1 : 2;
+  }
+  for (uint32_t p = 0; p < 8; ++p) {
+    m_params.priorityClass[p] = p < 2 ? 0 : p < 4 ? 1 : 2;
+  }
+  for (const std::string& item : Split(m_map, ',')) {
+    std::vector<std::string> kv = Split(item, '=');
+    NS_ABORT_MSG_IF(kv.size() != 2, "--qosMap: expected <value>=<class>, got `" << item << "`");
+    double value = Number(kv[0], "--qosMap");
+    double cls = Number(kv[1], "--qosMap");
+    NS_ABORT_MSG_IF(value >= (dscp ? 64 : 8),
+                    "--qosMap: " << (dscp ? "DSCP values are 0..63" : "Zenoh priorities are 0..7"));
+    NS_ABORT_MSG_IF(cls >= m_params.weights.size(),
+                    "--qosMap: class " << kv[1] << " does not exist");
+    (dscp ? m_params.dscpClass : m_params.priorityClass)[static_cast<uint32_t>(value)] = cls;
+  }
+  NS_ABORT_MSG_IF(m_rates.size() > m_params.weights.size(),
+                  "--qosRate has more entries than there are classes");
+
+  std::vector<EmulatedLink>& links = m_topology.GetLinks();
+  for (uint32_t i = 0; i < links.size(); ++i) {
+    const EmulatedLink& link = links[i];
+    PriorityQueueParams params = m_params;
+    params.rateBps = RatesOf(link);
+    // A shallower bucket would never let a conforming class send a full frame.
+    for (const auto& end : link.ends) {
+      params.burstBytes = std::max(params.burstBytes, end.device->GetMtu() + kFrameOverhead);
+    }
+    for (uint32_t side = 0; side < 2; ++side) {
+      Ptr<PriorityLinkQueue> queue = CreateObject<PriorityLinkQueue>();
+      queue->SetParams(params);
+      Ptr<NetDevice> device = link.ends[side].device;
+      if (Ptr<CsmaNetDevice> csma = DynamicCast<CsmaNetDevice>(device)) {
+        csma->SetQueue(queue);
+      } else if (Ptr<P2pEthernetNetDevice> p2p = DynamicCast<P2pEthernetNetDevice>(device)) {
+        p2p->SetQueue(queue);
+      } else {
+        NS_ABORT_MSG("LinkQos: unsupported device on link " << link.name);
+      }
+      m_queues.push_back(EndQueue{2 * i + side, queue});
+    }
+  }
+  std::ostringstream classes;
+  for (uint32_t c = 0; c < m_params.weights.size(); ++c) {
+    classes << (c ? "," : "");
+    if (m_params.weights[c] == 0) {
+      classes << "sp";
+    } else {
+      classes << m_params.weights[c];
+    }
+  }
+  NS_LOG_UNCOND("qos: " << (dscp ? "DSCP" : "Zenoh priority") << " classes " << classes.str()
+                        << " on " << m_queues.size() << " link ends, "
+                        << m_params.limitBytes / 1024 << " KiB per class");
+}
+
+std::vector<uint64_t> LinkQos::RatesOf(const EmulatedLink& link) const {
+  std::vector<uint64_t> rates;
+  for (double fraction : m_rates) {
+    rates.push_back(static_cast<uint64_t>(fraction * link.config.capMbps * 1e6));
+  }
+  return rates;
+}
+
+void LinkQos::CapChanged(EmulatedLink* link) {
+  if (m_queues.empty() || m_rates.empty()) {
+    return;
+  }
+  uint32_t i = link - m_topology.GetLinks().data();
+  for (uint32_t side = 0; side < 2; ++side) {
+    m_queues[2 * i + side].queue->SetRates(RatesOf(*link));
+  }
+}
+
+void LinkQos::Finish() {
+  if (m_queues.empty()) {
+    return;
+  }
+  const std::vector<EmulatedLink>& links = m_topology.GetLinks();
+  uint32_t n = m_params.weights.size();
+  std::vector<PriorityLinkQueue::ClassStats> totals(n);
+
+  std::ofstream os(m_outputDir + "/qos_classes.csv");
+  os << "link,from,to,class,weight,rate_mbps,packets,bytes,drops,drop_bytes,over_rate,"
+        "delay_mean_ms,delay_p50_ms,delay_p99_ms,delay_max_ms\n";
+  for (const EndQueue& q : m_queues) {
+    const EmulatedLink& link = links[q.dir / 2];
+    uint32_t side = q.dir % 2;
+    for (uint32_t c = 0; c < n; ++c) {
+      const PriorityLinkQueue::ClassStats& s = q.queue->GetClassStats(c);
+      double rate = c < m_rates.size() ? m_rates[c] * link.config.capMbps : 0;
+      os << link.name << "," << link.ends[side].nodeId << "," << link.ends[1 - side].nodeId << ","
+         << c << "," << m_params.weights[c] << "," << rate << "," << s.packets << "," << s.bytes
+         << "," << s.drops << "," << s.dropBytes << "," << s.overRate << ","
+         << Ms(s.delay.Mean()) << "," << Ms(s.delay.Percentile(0.5)) << ","
+         << Ms(s.delay.Percentile(0.99)) << "," << Ms(s.delay.Max()) << "\n";
+      PriorityLinkQueue::ClassStats& t = totals[c];
+      t.packets += s.packets;
+      t.bytes += s.bytes;
+      t.drops += s.drops;
+      t.dropBytes += s.dropBytes;
+      t.overRate += s.overRate;
+      t.delay.Merge(s.delay);
+    }
+  }
+  for (uint32_t c = 0; c < n; ++c) {
+    const PriorityLinkQueue::ClassStats& t = totals[c];
+    NS_LOG_UNCOND("qos class " << c << ": " << t.packets << " frames, " << t.drops << " drops, "
+                               << t.overRate << " over rate, queue delay mean "
+                               << Ms(t.delay.Mean()) << " ms, p99 "
+                               << Ms(t.delay.Percentile(0.99)) << " ms, max "
+                               << Ms(t.delay.Max()) << " ms");
+  }
+}
+
+}  // namespace ns3
@@ -0,0 +1,71 @@
+#ifndef ZENOH_SIM_LINK_QOS_H
+#define ZENOH_SIM_LINK_QOS_H
+
+#include "emulated-topology.h"
+#include "priority-link-queue.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Replaces the FIFO transmit queue of every link end with a
+ * PriorityLinkQueue, a link-layer QoS baseline to compare Zenoh's own
+ * rerouting against.
+ *
+ * Classes are given most urgent first, as "sp" (strict priority) or a WDRR
+ * weight. The default mapping is, by Zenoh priority: Control and RealTime to
+ * class 0, InteractiveHigh and InteractiveLow to class 1, Data and below
+ * (DataHigh, Data, DataLow, Background) to class 2. By DSCP: 40 and above
+ * (CS5, EF, CS6, CS7) to class 0, 16..39 to class 1, the rest to class 2.
+ * So the default "sp,4,1" serves class 0 first and shares the rest 4:1
+ * between the interactive priorities and everything from DataHigh down.
+ * SetMap overrides single entries. Classes past the last one fold into it.
+ *
+ * Token bucket rates are fractions of the link's `cap`, and follow it when
+ * a scenario changes it (CapChanged). At the end, qos_classes.csv holds the
+ * packets, drops and queue delays of every class on every link direction,
+ * and the log has the totals per class.
+ */
+class LinkQos {
+ public:
+  LinkQos(EmulatedTopology& topology, const std::string& outputDir);
+
+  void SetClassifier(PriorityQueueParams::Classifier classifier);
+  /// Comma separated classes, most urgent first: "sp" or a WDRR weight.
+  void SetClasses(const std::string& classes);
+  /// Comma separated <DSCP or Zenoh priority>=<class> entries over the defaults.
+  void SetMap(const std::string& map);
+  /// Comma separated token bucket rate of every class as a fraction of the link cap (0: none).
+  void SetRates(const std::string& rates);
+  /// Token bucket depth; at least one full frame of the link.
+  void SetBurst(uint32_t bytes);
+  void SetQueueLimit(uint32_t bytes);
+
+  /// Installs the queues; call right after Build, before anything hooks TxQueue.
+  void Start();
+  /// Recomputes the token bucket rates of `link` from its new cap.
+  void CapChanged(EmulatedLink* link);
+  /// Writes qos_classes.csv.
+  void Finish();
+
+ private:
+  struct EndQueue {
+    uint32_t dir;  ///< 2 * link + side
+    Ptr<PriorityLinkQueue> queue;
+  };
+
+  std::vector<uint64_t> RatesOf(const EmulatedLink& link) const;
+
+  EmulatedTopology& m_topology;
+  std::string m_outputDir;
+  PriorityQueueParams m_params;
+  std::string m_map;
+  std::vector<double> m_rates;
+  std::vector<EndQueue> m_queues;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_LINK_QOS_H
@@ -0,0 +1,228 @@
+#include "link-scenario.h"
+
+#include "p2p-ethernet-channel.h"
+#include "p2p-ethernet-net-device.h"
+
+#include "ns3/abort.h"
+#include "ns3/csma-module.h"
+#include "ns3/error-model.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("LinkScenario");
+
+namespace {
+
+const char* const kScenarioFile = "LINK_SCENARIO.json5";
+
+/// Resolves `link: "L<n>"` or `a`/`b` node ids to an index into `links`.
+uint32_t FindLink(const Json5Value& event, const NetworkConfig& config, const std::string& where) {
+  if (event.Has("link")) {
+    const std::string& name = event.Get("link").AsString();
+    for (uint32_t i = 0; i < config.links.size(); ++i) {
+      if (config.links[i].Name(i) == name) {
+        return i;
+      }
+    }
+    NS_FATAL_ERROR(where << ": no link named " << name);
+  }
+  std::string a = event.GetString("a", "");
+  std::string b = event.GetString("b", "");
+  NS_ABORT_MSG_IF(a.empty() || b.empty(), where << ": needs `link` or both `a` and `b`");
+  uint32_t found = config.links.size();
+  for (uint32_t i = 0; i < config.links.size(); ++i) {
+    const LinkConfig& lc = config.links[i];
+    if ((lc.a == a && lc.b == b) || (lc.a == b && lc.b == a)) {
+      NS_ABORT_MSG_IF(found != config.links.size(),
+                      where << ": nodes " << a << " and " << b
+                            << " share more than one link, use `link` instead");
+      found = i;
+    }
+  }
+  NS_ABORT_MSG_IF(found == config.links.size(),
+                  where << ": no link between nodes " << a << " and " << b);
+  return found;
+}
+
+std::string Format(double value) {
+  std::ostringstream oss;
+  oss << value;
+  return oss.str();
+}
+
+}  // namespace
+
+std::string LinkScenario::DefaultPath(const NetworkConfig& config) {
+  std::string::size_type slash = config.path.rfind('/');
+  std::string dir = slash == std::string::npos ? "." : config.path.substr(0, slash);
+  return dir + "/" + kScenarioFile;
+}
+
+LinkScenario LinkScenario::Load(const std::string& path, const NetworkConfig& config) {
+  LinkScenario scenario;
+  scenario.m_path = path;
+  Json5Value doc = Json5Value::Load(path);
+  NS_ABORT_MSG_IF(!doc.IsObject(), path << ": top level must be an object");
+
+  uint32_t n = 0;
+  for (const auto& event : doc.Get("events").Elements()) {
+    std::ostringstream where;
+    where << path << ": event " << n++;
+    LinkChange change;
+    change.atS = event.Get("at").AsNumber();
+    change.link = FindLink(event, config, where.str());
+    if (event.Has("cap")) {
+      change.capMbps = event.Get("cap").AsNumber();
+      NS_ABORT_MSG_IF(*change.capMbps <= 0, where.str() << ": cap must be positive");
+    }
+    if (event.Has("delay")) {
+      change.delayMs = event.Get("delay").AsNumber();
+      NS_ABORT_MSG_IF(*change.delayMs < 0, where.str() << ": delay must not be negative");
+    }
+    if (event.Has("loss")) {
+      change.loss = event.Get("loss").AsNumber();
+      NS_ABORT_MSG_IF(*change.loss < 0 || *change.loss > 1,
+                      where.str() << ": loss is a probability between 0 and 1");
+    }
+    if (event.Has("state")) {
+      const std::string& state = event.Get("state").AsString();
+      NS_ABORT_MSG_IF(state != "up" && state != "down",
+                      where.str() << ": state must be up or down");
+      change.up = state == "up";
+    }
+    NS_ABORT_MSG_IF(change.atS < 0, where.str() << ": `at` must not be negative");
+    NS_ABORT_MSG_IF(!change.capMbps && !change.delayMs && !change.loss && !change.up,
+                    where.str() << ": nothing to change, expected cap, delay, loss or state");
+    scenario.m_changes.push_back(change);
+  }
+  return scenario;
+}
+
+void LinkScenario::Schedule(EmulatedTopology& topology, const std::string& logPath) {
+  m_log.open(logPath);
+  NS_ABORT_MSG_IF(!m_log, "cannot open " << logPath);
+  m_log << "sim_s,wall_time,link,tap_a,tap_b,change,value\n";
+  m_log.flush();
+
+  uint32_t scheduled = 0;
+  for (const LinkChange& change : m_changes) {
+    for (auto& link : topology.GetLinks()) {
+      if (link.index == change.link) {
+        Simulator::Schedule(Seconds(change.atS), &LinkScenario::Apply, this, &link, change);
+        ++scheduled;
+      }
+    }
+  }
+  NS_LOG_UNCOND("scenario " << m_path << ": " << scheduled << " link changes scheduled");
+}
+
+void LinkScenario::SetCapCallback(Callback<void, EmulatedLink*> capChanged) {
+  m_capChanged = capChanged;
+}
+
+void LinkScenario::Apply(EmulatedLink* link, LinkChange change) {
+  // Link state first, so a link coming up already has its new conditions.
+  if (change.up && !*change.up) {
+    SetUp(link, false);
+  }
+  if (change.capMbps) {
+    DataRate rate(static_cast<uint64_t>(*change.capMbps * 1e6));
+    link->config.capMbps = *change.capMbps;
+    if (link->type == "p2p") {
+      for (auto& end : link->ends) {
+        DynamicCast<P2pEthernetNetDevice>(end.device)->SetDataRate(rate);
+      }
+      CapApplied(link);
+    } else {
+      SetCsmaRate(link, rate);
+    }
+  }
+  if (change.delayMs) {
+    // Both channel types read Delay for every frame they deliver.
+    link->config.delayMs = *change.delayMs;
+    link->channel->SetAttribute("Delay", TimeValue(Seconds(*change.delayMs / 1000.0)));
+    Log(*link, "delay", Format(*change.delayMs));
+  }
+  if (change.loss) {
+    SetLoss(link, *change.loss);
+  }
+  if (change.up && *change.up) {
+    SetUp(link, true);
+  }
+}
+
+void LinkScenario::SetCsmaRate(EmulatedLink* link, DataRate rate) {
+  // CsmaNetDevice has no rate setter: it copies the channel rate in Attach,
+  // so the devices are detached and attached again. That is only safe while
+  // no frame is on the wire; otherwise try again shortly. CsmaChannel keeps
+  // a detached device as an inactive entry, so the channel gains two entries
+  // per cap change, which the scenario bounds.
+  Ptr<CsmaChannel> channel = DynamicCast<CsmaChannel>(link->channel);
+  if (channel->IsBusy()) {
+    Simulator::Schedule(MicroSeconds(10), &LinkScenario::SetCsmaRate, this, link, rate);
+    return;
+  }
+  channel->SetAttribute("DataRate", DataRateValue(rate));
+  for (auto& end : link->ends) {
+    Ptr<CsmaNetDevice> device = DynamicCast<CsmaNetDevice>(end.device);
+    channel->Detach(device);
+    device->Attach(channel);
+  }
+  CapApplied(link);
+}
+
+void LinkScenario::CapApplied(EmulatedLink* link) {
+  Log(*link, "cap", Format(link->config.capMbps));
+  if (!m_capChanged.IsNull()) {
+    m_capChanged(link);
+  }
+}
+
+void LinkScenario::SetLoss(EmulatedLink* link, double loss) {
+  for (auto& end : link->ends) {
+    Ptr<RateErrorModel> em;
+    if (loss > 0) {
+      em = CreateObject<RateErrorModel>();
+      em->SetUnit(RateErrorModel::ERROR_UNIT_PACKET);
+      em->SetRate(loss);
+    }
+    if (link->type == "p2p") {
+      DynamicCast<P2pEthernetNetDevice>(end.device)->SetReceiveErrorModel(em);
+    } else {
+      DynamicCast<CsmaNetDevice>(end.device)->SetReceiveErrorModel(em);
+    }
+  }
+  Log(*link, "loss", Format(loss));
+}
+
+void LinkScenario::SetUp(EmulatedLink* link, bool up) {
+  for (auto& end : link->ends) {
+    if (link->type == "p2p") {
+      DynamicCast<P2pEthernetNetDevice>(end.device)->SetLinkUp(up);
+    } else {
+      Ptr<CsmaNetDevice> device = DynamicCast<CsmaNetDevice>(end.device);
+      device->SetSendEnable(up);
+      device->SetReceiveEnable(up);
+    }
+  }
+  Log(*link, "state", up ? "up" : "down");
+}
+
+void LinkScenario::Log(const EmulatedLink& link, const std::string& what, const std::string& value) {
+  double wall = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch())
+                    .count();
+  double sim = Simulator::Now().GetSeconds();
+  m_log << std::fixed << std::setprecision(6) << sim << "," << wall << "," << link.name << ","
+        << link.ends[0].tapName << "," << link.ends[1].tapName << "," << what << "," << value
+        << "\n";
+  m_log.flush();
+  NS_LOG_UNCOND("t=" << sim << "s " << link.name << " " << what << "=" << value);
+}
+
+}  // namespace ns3
@@ -0,0 +1,79 @@
+#ifndef ZENOH_SIM_LINK_SCENARIO_H
+#define ZENOH_SIM_LINK_SCENARIO_H
+
+#include "emulated-topology.h"
+#include "network-config.h"
+
+#include "ns3/callback.h"
+#include "ns3/data-rate.h"
+
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/// One `events` entry of a link scenario: what changes on which link, and when.
+struct LinkChange {
+  double atS;      ///< simulation time in seconds
+  uint32_t link;   ///< index into `links`
+  std::optional<double> capMbps;
+  std::optional<double> delayMs;
+  std::optional<double> loss;  ///< frame loss probability in each direction
+  std::optional<bool> up;
+};
+
+/**
+ * Time-varying link conditions read from LINK_SCENARIO.json5, next to the
+ * experiment's NETWORK_CONFIG.json5:
+ *
+ *   {
+ *     events: [
+ *       { at: 30, link: "L6", cap: 100 },       // Mbps, like `cap`
+ *       { at: 60, a: "3", b: "4", delay: 40 },  // ms, like `delay`
+ *       { at: 90, link: "L5", loss: 0.02 },     // 0 removes the loss again
+ *       { at: 120, link: "L5", state: "down" }, // or "up"
+ *     ]
+ *   }
+ *
+ * A link is named like in the emulator's output ("L<n>", n-th entry of
+ * `links`) or by its two node ids. The changes are applied to the running
+ * channels and devices, so the TAP bridges and the TCP sessions over them
+ * stay in place. Every applied change is appended to link_events.csv with
+ * its simulation and wall-clock time.
+ */
+class LinkScenario {
+ public:
+  /// LINK_SCENARIO.json5 in the directory of the config file.
+  static std::string DefaultPath(const NetworkConfig& config);
+  static LinkScenario Load(const std::string& path, const NetworkConfig& config);
+
+  /**
+   * Schedules the changes of the links present in `topology` (a shard may
+   * own only some of them) and opens the event log.
+   */
+  void Schedule(EmulatedTopology& topology, const std::string& logPath);
+  /// Called once a new cap is in effect on both ends of a link.
+  void SetCapCallback(Callback<void, EmulatedLink*> capChanged);
+
+  const std::string& GetPath() const { return m_path; }
+  const std::vector<LinkChange>& GetChanges() const { return m_changes; }
+
+ private:
+  void Apply(EmulatedLink* link, LinkChange change);
+  void SetCsmaRate(EmulatedLink* link, DataRate rate);
+  void CapApplied(EmulatedLink* link);
+  void SetLoss(EmulatedLink* link, double loss);
+  void SetUp(EmulatedLink* link, bool up);
+  void Log(const EmulatedLink& link, const std::string& what, const std::string& value);
+
+  std::string m_path;
+  std::vector<LinkChange> m_changes;
+  std::ofstream m_log;
+  Callback<void, EmulatedLink*> m_capChanged;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_LINK_SCENARIO_H
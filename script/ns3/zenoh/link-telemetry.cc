@@ -0,0 +1,199 @@
+#include "link-telemetry.h"
+
+#include "ns3/abort.h"
+#include "ns3/callback.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("LinkTelemetry");
+
+namespace {
+
+const uint32_t kVersion = 1;
+const uint32_t kFieldsPerEndpoint = 7;
+const uint32_t kBlockHeader = 16;
+
+void PutString(std::FILE* f, const std::string& s) {
+  uint16_t len = s.size();
+  std::fwrite(&len, sizeof(len), 1, f);
+  std::fwrite(s.data(), 1, len, f);
+}
+
+}  // namespace
+
+LinkTelemetry::LinkTelemetry(EmulatedTopology& topology, const std::string& path, Time interval)
+    : m_topology(topology),
+      m_path(path),
+      m_interval(interval),
+      m_file(nullptr),
+      m_blockSize(0),
+      m_ringBlocks(4096),
+      m_head(0),
+      m_tail(0),
+      m_dropped(0),
+      m_stopWriter(false) {}
+
+LinkTelemetry::~LinkTelemetry() {
+  Stop();
+}
+
+void LinkTelemetry::SetRingBlocks(uint32_t blocks) {
+  m_ringBlocks = blocks;
+}
+
+void LinkTelemetry::OnRx(Endpoint* ep, Ptr<const Packet> p) {
+  ep->rxBytes += p->GetSize();
+  ++ep->rxFrames;
+}
+
+void LinkTelemetry::OnDrop(Endpoint* ep, Ptr<const Packet> p) {
+  ++ep->drops;
+}
+
+void LinkTelemetry::Start() {
+  // Size everything up front: the trace callbacks keep pointers into
+  // m_endpoints and the ring is never reallocated.
+  uint32_t n = 2 * m_topology.GetLinks().size();
+  m_endpoints.assign(n, Endpoint());
+  m_blockSize = kBlockHeader + n * kFieldsPerEndpoint * sizeof(uint32_t);
+  m_ring.assign(static_cast<size_t>(m_blockSize) * m_ringBlocks, 0);
+
+  uint32_t i = 0;
+  for (auto& link : m_topology.GetLinks()) {
+    for (auto& end : link.ends) {
+      Endpoint& ep = m_endpoints[i++];
+      PointerValue queue;
+      end.device->GetAttribute("TxQueue", queue);
+      ep.queue = queue.Get<Queue<Packet>>();
+      end.device->TraceConnectWithoutContext("MacPromiscRx",
+                                             MakeBoundCallback(&LinkTelemetry::OnRx, &ep));
+      end.device->TraceConnectWithoutContext("MacTxDrop",
+                                             MakeBoundCallback(&LinkTelemetry::OnDrop, &ep));
+      end.device->TraceConnectWithoutContext("PhyRxDrop",
+                                             MakeBoundCallback(&LinkTelemetry::OnDrop, &ep));
+    }
+  }
+
+  m_file = std::fopen(m_path.c_str(), "wb");
+  NS_ABORT_MSG_IF(!m_file, "cannot open " << m_path);
+  WriteHeader();
+  m_writer = std::thread(&LinkTelemetry::WriterLoop, this);
+  Simulator::Schedule(m_interval, &LinkTelemetry::Sample, this);
+}
+
+void LinkTelemetry::WriteHeader() {
+  uint32_t n = m_endpoints.size();
+  int64_t intervalNs = m_interval.GetNanoSeconds();
+  std::fwrite("ZTEL", 1, 4, m_file);
+  std::fwrite(&kVersion, sizeof(kVersion), 1, m_file);
+  std::fwrite(&n, sizeof(n), 1, m_file);
+  std::fwrite(&m_blockSize, sizeof(m_blockSize), 1, m_file);
+  std::fwrite(&intervalNs, sizeof(intervalNs), 1, m_file);
+  for (const auto& link : m_topology.GetLinks()) {
+    for (uint8_t side = 0; side < 2; ++side) {
+      uint32_t index = link.index;
+      double cap = link.config.capMbps;
+      std::fwrite(&index, sizeof(index), 1, m_file);
+      std::fwrite(&side, sizeof(side), 1, m_file);
+      std::fwrite(&cap, sizeof(cap), 1, m_file);
+      PutString(m_file, link.name);
+      PutString(m_file, link.ends[side].tapName);
+      PutString(m_file, link.ends[side].nodeId);
+    }
+  }
+}
+
+void LinkTelemetry::Sample() {
+  uint64_t head = m_head.load(std::memory_order_relaxed);
+  bool full = head - m_tail.load(std::memory_order_acquire) >= m_ringBlocks;
+  uint8_t* block = full ? nullptr : &m_ring[(head % m_ringBlocks) * m_blockSize];
+
+  if (block) {
+    int64_t times[2] = {std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count(),
+                        Simulator::Now().GetNanoSeconds()};
+    std::memcpy(block, times, sizeof(times));
+  }
+
+  uint32_t* out = block ? reinterpret_cast<uint32_t*>(block + kBlockHeader) : nullptr;
+  for (auto& ep : m_endpoints) {
+    const Ptr<Queue<Packet>>& q = ep.queue;
+    uint64_t txBytes =
+        q->GetTotalReceivedBytes() - q->GetNBytes() - q->GetTotalDroppedBytesAfterDequeue();
+    uint64_t txFrames = q->GetTotalReceivedPackets() - q->GetNPackets() -
+                        q->GetTotalDroppedPacketsAfterDequeue();
+    uint64_t drops = ep.drops + q->GetTotalDroppedPacketsAfterDequeue();
+    if (out) {
+      out[0] = txBytes - ep.lastTxBytes;
+      out[1] = txFrames - ep.lastTxFrames;
+      out[2] = ep.rxBytes - ep.lastRxBytes;
+      out[3] = ep.rxFrames - ep.lastRxFrames;
+      out[4] = drops - ep.lastDrops;
+      out[5] = q->GetNPackets();
+      out[6] = q->GetNBytes();
+      out += kFieldsPerEndpoint;
+    }
+    // Deltas are taken even for a dropped block so the next one stays exact.
+    ep.lastTxBytes = txBytes;
+    ep.lastTxFrames = txFrames;
+    ep.lastRxBytes = ep.rxBytes;
+    ep.lastRxFrames = ep.rxFrames;
+    ep.lastDrops = drops;
+  }
+
+  if (block) {
+    m_head.store(head + 1, std::memory_order_release);
+  } else {
+    ++m_dropped;
+  }
+  Simulator::Schedule(m_interval, &LinkTelemetry::Sample, this);
+}
+
+void LinkTelemetry::Drain() {
+  uint64_t tail = m_tail.load(std::memory_order_relaxed);
+  uint64_t head = m_head.load(std::memory_order_acquire);
+  while (tail < head) {
+    // Write the contiguous run up to the ring's end in one call.
+    uint64_t slot = tail % m_ringBlocks;
+    uint64_t count = std::min<uint64_t>(head - tail, m_ringBlocks - slot);
+    std::fwrite(&m_ring[slot * m_blockSize], m_blockSize, count, m_file);
+    tail += count;
+    m_tail.store(tail, std::memory_order_release);
+  }
+}
+
+void LinkTelemetry::WriterLoop() {
+  while (!m_stopWriter.load(std::memory_order_acquire)) {
+    Drain();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  Drain();
+}
+
+void LinkTelemetry::Stop() {
+  if (!m_file) {
+    return;
+  }
+  m_stopWriter.store(true, std::memory_order_release);
+  if (m_writer.joinable()) {
+    m_writer.join();
+  }
+  uint64_t written = m_tail.load();
+  std::fwrite("ZEND", 1, 4, m_file);
+  std::fwrite(&written, sizeof(written), 1, m_file);
+  std::fwrite(&m_dropped, sizeof(m_dropped), 1, m_file);
+  std::fclose(m_file);
+  m_file = nullptr;
+  NS_LOG_UNCOND("telemetry: " << written << " samples (" << m_dropped << " dropped) in "
+                              << m_path);
+}
+
+}  // namespace ns3
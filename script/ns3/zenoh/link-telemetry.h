@@ -0,0 +1,92 @@
+#ifndef ZENOH_SIM_LINK_TELEMETRY_H
+#define ZENOH_SIM_LINK_TELEMETRY_H
+
+#include "emulated-topology.h"
+
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Samples every link end at a fixed interval (down to ~10 ms): TX/RX bytes
+ * and frames, drops, and device queue occupancy.
+ *
+ * The sampling event only copies counters into a preallocated ring of sample
+ * blocks; a background thread drains the ring into a binary file, so disk I/O
+ * never runs on the real-time loop. If the writer falls a whole ring behind,
+ * samples are dropped and counted rather than blocking the simulator.
+ *
+ * File layout (little endian), read by script/tools/telemetry_to_csv.py:
+ *   header  "ZTEL" u32 version, u32 endpoints, u32 block size, i64 interval ns
+ *   per endpoint: u32 link index, u8 side, f64 cap Mbps, then link name,
+ *                 TAP name and node id as u16 length + bytes
+ *   blocks  i64 wall-clock ns since epoch, i64 simulation ns, then per
+ *           endpoint 7 x u32: tx bytes, tx frames, rx bytes, rx frames and
+ *           drops since the previous block, queue packets, queue bytes
+ *   trailer "ZEND" u64 blocks written, u64 blocks dropped
+ */
+class LinkTelemetry {
+ public:
+  LinkTelemetry(EmulatedTopology& topology, const std::string& path, Time interval);
+  ~LinkTelemetry();
+
+  /// Capacity of the ring, in sample blocks (default 4096).
+  void SetRingBlocks(uint32_t blocks);
+
+  /// Hooks the device traces, starts the writer thread and the sampling.
+  void Start();
+  /// Flushes everything and closes the file; call after Simulator::Run.
+  void Stop();
+
+ private:
+  struct Endpoint {
+    Ptr<Queue<Packet>> queue;
+    uint64_t rxBytes;
+    uint64_t rxFrames;
+    /// MacTxDrop (queue full, link down) and PhyRxDrop (receive errors). A full
+    /// queue fires MacTxDrop too, so its drop counter is not added again.
+    uint64_t drops;
+    // cumulative values at the previous sample
+    uint64_t lastTxBytes;
+    uint64_t lastTxFrames;
+    uint64_t lastRxBytes;
+    uint64_t lastRxFrames;
+    uint64_t lastDrops;
+  };
+
+  static void OnRx(Endpoint* ep, Ptr<const Packet> p);
+  static void OnDrop(Endpoint* ep, Ptr<const Packet> p);
+
+  void WriteHeader();
+  void Sample();
+  void WriterLoop();
+  void Drain();
+
+  EmulatedTopology& m_topology;
+  std::string m_path;
+  Time m_interval;
+  std::FILE* m_file;
+
+  std::vector<Endpoint> m_endpoints;
+  uint32_t m_blockSize;
+  uint32_t m_ringBlocks;
+  std::vector<uint8_t> m_ring;
+  std::atomic<uint64_t> m_head;  ///< next block the simulator writes
+  std::atomic<uint64_t> m_tail;  ///< next block the writer flushes
+  uint64_t m_dropped;
+  std::atomic<bool> m_stopWriter;
+  std::thread m_writer;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_LINK_TELEMETRY_H
@@ -0,0 +1,96 @@
+#ifndef ZENOH_SIM_LOG_HISTOGRAM_H
+#define ZENOH_SIM_LOG_HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace ns3 {
+
+/**
+ * Fixed-size log-linear histogram of non-negative integers (typically
+ * nanoseconds): exact below 16, then 8 buckets per power of two, so any
+ * percentile is reported within 12.5%. Adding a sample is a couple of
+ * arithmetic operations and never allocates, which keeps it usable on the
+ * real-time event path.
+ */
+class LogHistogram {
+ public:
+  static const uint32_t kBuckets = 496;
+
+  LogHistogram() { Reset(); }
+
+  void Reset() {
+    m_counts.fill(0);
+    m_count = 0;
+    m_sum = 0;
+    m_max = 0;
+  }
+
+  void Add(uint64_t value) {
+    ++m_counts[Bucket(value)];
+    ++m_count;
+    m_sum += value;
+    m_max = std::max(m_max, value);
+  }
+
+  void Merge(const LogHistogram& other) {
+    for (uint32_t i = 0; i < kBuckets; ++i) {
+      m_counts[i] += other.m_counts[i];
+    }
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_max = std::max(m_max, other.m_max);
+  }
+
+  uint64_t Count() const { return m_count; }
+  uint64_t Max() const { return m_max; }
+  double Mean() const { return m_count ? static_cast<double>(m_sum) / m_count : 0; }
+
+  /// Samples in bucket `b` (0..kBuckets-1), whose values are at most BucketUpper(b).
+  uint64_t BucketCount(uint32_t b) const { return m_counts[b]; }
+
+  /// Upper bound of the bucket holding quantile q (0..1), capped at Max().
+  uint64_t Percentile(double q) const {
+    if (m_count == 0) {
+      return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * m_count);
+    rank = std::max<uint64_t>(1, std::min(rank, m_count));
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < kBuckets; ++i) {
+      seen += m_counts[i];
+      if (seen >= rank) {
+        return std::min(BucketUpper(i), m_max);
+      }
+    }
+    return m_max;
+  }
+
+  static uint64_t BucketUpper(uint32_t b) {
+    if (b < 16) {
+      return b;
+    }
+    uint32_t e = b / 8 + 2;
+    uint64_t lower = static_cast<uint64_t>(8 + b % 8) << (e - 3);
+    return lower + (uint64_t(1) << (e - 3)) - 1;
+  }
+
+ private:
+  static uint32_t Bucket(uint64_t v) {
+    if (v < 16) {
+      return static_cast<uint32_t>(v);
+    }
+    uint32_t e = 63 - __builtin_clzll(v);
+    return (e - 2) * 8 + static_cast<uint32_t>((v >> (e - 3)) & 7);
+  }
+
+  std::array<uint64_t, kBuckets> m_counts;
+  uint64_t m_count;
+  uint64_t m_sum;
+  uint64_t m_max;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_LOG_HISTOGRAM_H
@@ -0,0 +1,105 @@
+#include "network-config.h"
+
+#include "ns3/abort.h"
+
+#include <set>
+#include <sstream>
+
+namespace ns3 {
+
+namespace {
+
+const double kDefaultDelayMs = 1.0;
+const char* const kDefaultLinkType = "csma";
+
+}  // namespace
+
+std::string LinkConfig::Name(uint32_t index) const {
+  std::ostringstream oss;
+  oss << "L" << index + 1;
+  return oss.str();
+}
+
+std::string NetworkConfig::TapName(const std::string& id, uint32_t idx) {
+  std::ostringstream oss;
+  oss << "tap_" << id << "_" << idx;
+  return oss.str();
+}
+
+uint32_t NetworkConfig::NodeIndex(const std::string& id) const {
+  for (uint32_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i].id == id) {
+      return i;
+    }
+  }
+  NS_FATAL_ERROR(path << ": unknown node \"" << id << "\"");
+}
+
+const std::string& NetworkConfig::LinkType(const LinkConfig& link) const {
+  return link.linkType.empty() ? defaultLinkType : link.linkType;
+}
+
+void NetworkConfig::CheckLinkType(const std::string& type, const std::string& where) {
+  NS_ABORT_MSG_IF(type != "csma" && type != "p2p",
+                  where << ": unknown link_type \"" << type << "\", expected csma or p2p");
+}
+
+NetworkConfig NetworkConfig::Load(const std::string& path) {
+  NetworkConfig config;
+  config.path = path;
+  config.document = Json5Value::Load(path);
+  const Json5Value& doc = config.document;
+  NS_ABORT_MSG_IF(!doc.IsObject(), path << ": top level must be an object");
+
+  config.experiment = doc.GetString("experiment", "");
+  config.defaultLinkType = doc.GetString("link_type", kDefaultLinkType);
+  CheckLinkType(config.defaultLinkType, path);
+
+  for (const auto& member : doc.Get("nodes").Members()) {
+    NodeConfig node;
+    node.id = member.first;
+    node.role = member.second.GetString("role", "router");
+    node.zid = member.second.Get("zid").GetString("value", "");
+    for (const auto& ep : member.second.Get("listen_endpoints").Elements()) {
+      node.listenEndpoints.push_back(ep.AsString());
+    }
+    config.nodes.push_back(node);
+  }
+
+  // Every (node, endpoint index) pair owns exactly one TAP, so it may appear
+  // in at most one link.
+  std::set<std::string> taps;
+  for (const auto& entry : doc.Get("links").Elements()) {
+    LinkConfig link;
+    link.a = entry.GetString("a", "");
+    link.aIdx = static_cast<uint32_t>(entry.Get("a_idx").AsInt());
+    link.b = entry.GetString("b", "");
+    link.bIdx = static_cast<uint32_t>(entry.Get("b_idx").AsInt());
+    link.capMbps = entry.GetNumber("cap", 0);
+    link.delayMs = entry.GetNumber("delay", kDefaultDelayMs);
+    link.linkType = entry.GetString("link_type", "");
+    uint32_t index = config.links.size();
+    if (!link.linkType.empty()) {
+      CheckLinkType(link.linkType, path + ": link " + link.Name(index));
+    }
+
+    NS_ABORT_MSG_IF(link.capMbps <= 0,
+                    path << ": link " << link.Name(index) << " needs a positive cap");
+    NS_ABORT_MSG_IF(link.delayMs < 0,
+                    path << ": link " << link.Name(index) << " has a negative delay");
+    for (const auto& end : {std::make_pair(link.a, link.aIdx), std::make_pair(link.b, link.bIdx)}) {
+      const NodeConfig& node = config.nodes[config.NodeIndex(end.first)];
+      NS_ABORT_MSG_IF(end.second >= node.listenEndpoints.size(),
+                      path << ": link " << link.Name(index) << " uses endpoint " << end.second
+                           << " of node " << end.first << " which has only "
+                           << node.listenEndpoints.size());
+      std::string tap = TapName(end.first, end.second);
+      NS_ABORT_MSG_IF(!taps.insert(tap).second,
+                      path << ": " << tap << " is used by more than one link");
+    }
+    config.links.push_back(link);
+  }
+  return config;
+}
+
+}  // namespace ns3
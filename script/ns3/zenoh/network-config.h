@@ -0,0 +1,63 @@
+#ifndef ZENOH_SIM_NETWORK_CONFIG_H
+#define ZENOH_SIM_NETWORK_CONFIG_H
+
+#include "json5.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/// One entry of NETWORK_CONFIG.json5 `nodes`.
+struct NodeConfig {
+  std::string id;    ///< key in `nodes`, also used in the TAP names
+  std::string role;  ///< "pub", "sub" or "router" when omitted
+  std::string zid;
+  std::vector<std::string> listenEndpoints;
+};
+
+/// One entry of NETWORK_CONFIG.json5 `links`.
+struct LinkConfig {
+  std::string a;
+  uint32_t aIdx;
+  std::string b;
+  uint32_t bIdx;
+  double capMbps;  ///< `cap`, shared with zenohd's peer_caps
+  double delayMs;  ///< optional `delay`, one-way propagation delay
+  std::string linkType;  ///< optional `link_type`, empty means the default
+
+  /// Human readable link name used in logs and output files, e.g. "L3".
+  std::string Name(uint32_t index) const;
+};
+
+/**
+ * The parts of NETWORK_CONFIG.json5 the emulator needs. The same file drives
+ * zenohd-auto-deploy, so every emulated link and its capacity come from the
+ * exact entries the routers are configured with.
+ */
+class NetworkConfig {
+ public:
+  static NetworkConfig Load(const std::string& path);
+
+  /// TAP device name for endpoint `idx` of node `id`, as created by the launcher.
+  static std::string TapName(const std::string& id, uint32_t idx);
+
+  /// Index of the node in `nodes`, aborts if unknown.
+  uint32_t NodeIndex(const std::string& id) const;
+
+  /// Emulated link model of a link: "csma" (half-duplex) or "p2p" (full-duplex).
+  const std::string& LinkType(const LinkConfig& link) const;
+  static void CheckLinkType(const std::string& type, const std::string& where);
+
+  std::string path;
+  std::string experiment;
+  std::vector<NodeConfig> nodes;
+  std::vector<LinkConfig> links;
+  std::string defaultLinkType;  ///< top-level `link_type`, "csma" when omitted
+  Json5Value document;  ///< full parsed file, for optional sections
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_NETWORK_CONFIG_H
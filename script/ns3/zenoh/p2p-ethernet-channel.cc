@@ -0,0 +1,59 @@
+#include "p2p-ethernet-channel.h"
+
+#include "p2p-ethernet-net-device.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("P2pEthernetChannel");
+
+NS_OBJECT_ENSURE_REGISTERED(P2pEthernetChannel);
+
+TypeId P2pEthernetChannel::GetTypeId() {
+  static TypeId tid = TypeId("ns3::P2pEthernetChannel")
+                          .SetParent<Channel>()
+                          .AddConstructor<P2pEthernetChannel>()
+                          .AddAttribute("Delay",
+                                        "One-way propagation delay",
+                                        TimeValue(MilliSeconds(1)),
+                                        MakeTimeAccessor(&P2pEthernetChannel::m_delay),
+                                        MakeTimeChecker());
+  return tid;
+}
+
+P2pEthernetChannel::P2pEthernetChannel() : m_nDevices(0) {}
+
+void P2pEthernetChannel::Attach(Ptr<P2pEthernetNetDevice> device) {
+  NS_ABORT_MSG_IF(m_nDevices == 2, "P2pEthernetChannel: only two devices per channel");
+  m_devices[m_nDevices++] = device;
+}
+
+void P2pEthernetChannel::TransmitStart(Ptr<const Packet> p,
+                                       Ptr<P2pEthernetNetDevice> src,
+                                       Time txTime) {
+  NS_LOG_FUNCTION(this << p << src << txTime);
+  if (m_nDevices < 2) {
+    return;
+  }
+  Ptr<P2pEthernetNetDevice> dst = src == m_devices[0] ? m_devices[1] : m_devices[0];
+  Simulator::ScheduleWithContext(dst->GetNode()->GetId(),
+                                 txTime + m_delay,
+                                 &P2pEthernetNetDevice::Receive,
+                                 dst,
+                                 p->Copy());
+}
+
+std::size_t P2pEthernetChannel::GetNDevices() const {
+  return m_nDevices;
+}
+
+Ptr<NetDevice> P2pEthernetChannel::GetDevice(std::size_t i) const {
+  NS_ABORT_MSG_IF(i >= m_nDevices, "P2pEthernetChannel: no device " << i);
+  return m_devices[i];
+}
+
+}  // namespace ns3
@@ -0,0 +1,42 @@
+#ifndef ZENOH_SIM_P2P_ETHERNET_CHANNEL_H
+#define ZENOH_SIM_P2P_ETHERNET_CHANNEL_H
+
+#include "ns3/channel.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class P2pEthernetNetDevice;
+
+/**
+ * Full-duplex cable between exactly two P2pEthernetNetDevices. Each direction
+ * is an independent wire: the channel only adds the propagation delay, the
+ * serialization time is accounted for by the sending device.
+ */
+class P2pEthernetChannel : public Channel {
+ public:
+  static TypeId GetTypeId();
+
+  P2pEthernetChannel();
+
+  void Attach(Ptr<P2pEthernetNetDevice> device);
+
+  /// Delivers `p` to the other end once it has been fully serialized.
+  void TransmitStart(Ptr<const Packet> p, Ptr<P2pEthernetNetDevice> src, Time txTime);
+
+  Time GetDelay() const { return m_delay; }
+
+  std::size_t GetNDevices() const override;
+  Ptr<NetDevice> GetDevice(std::size_t i) const override;
+
+ private:
+  Time m_delay;
+  Ptr<P2pEthernetNetDevice> m_devices[2];
+  std::size_t m_nDevices;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_P2P_ETHERNET_CHANNEL_H
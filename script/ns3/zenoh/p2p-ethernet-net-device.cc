@@ -0,0 +1,315 @@
+#include "p2p-ethernet-net-device.h"
+
+#include "p2p-ethernet-channel.h"
+
+#include "ns3/drop-tail-queue.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("P2pEthernetNetDevice");
+
+NS_OBJECT_ENSURE_REGISTERED(P2pEthernetNetDevice);
+
+TypeId P2pEthernetNetDevice::GetTypeId() {
+  static TypeId tid =
+      TypeId("ns3::P2pEthernetNetDevice")
+          .SetParent<NetDevice>()
+          .AddConstructor<P2pEthernetNetDevice>()
+          .AddAttribute("Mtu",
+                        "The MAC-level Maximum Transmission Unit",
+                        UintegerValue(1500),
+                        MakeUintegerAccessor(&P2pEthernetNetDevice::SetMtu,
+                                             &P2pEthernetNetDevice::GetMtu),
+                        MakeUintegerChecker<uint16_t>())
+          .AddAttribute("Address",
+                        "The MAC address of this device.",
+                        Mac48AddressValue(Mac48Address("ff:ff:ff:ff:ff:ff")),
+                        MakeMac48AddressAccessor(&P2pEthernetNetDevice::m_address),
+                        MakeMac48AddressChecker())
+          .AddAttribute("DataRate",
+                        "Transmit rate of each direction",
+                        DataRateValue(DataRate("100Mbps")),
+                        MakeDataRateAccessor(&P2pEthernetNetDevice::m_bps),
+                        MakeDataRateChecker())
+          .AddAttribute("InterframeGap",
+                        "Idle time between two transmitted frames",
+                        TimeValue(Seconds(0)),
+                        MakeTimeAccessor(&P2pEthernetNetDevice::m_interframeGap),
+                        MakeTimeChecker())
+          .AddAttribute("TxQueue",
+                        "The transmit queue of the device",
+                        PointerValue(),
+                        MakePointerAccessor(&P2pEthernetNetDevice::m_queue),
+                        MakePointerChecker<Queue<Packet>>())
+          .AddAttribute("ReceiveErrorModel",
+                        "Error model deciding which received frames are lost",
+                        PointerValue(),
+                        MakePointerAccessor(&P2pEthernetNetDevice::m_receiveErrorModel),
+                        MakePointerChecker<ErrorModel>())
+          .AddTraceSource("MacTx",
+                          "A frame handed to the device for transmission",
+                          MakeTraceSourceAccessor(&P2pEthernetNetDevice::m_macTxTrace),
+                          "ns3::Packet::TracedCallback")
+          .AddTraceSource("MacTxDrop",
+                          "A frame dropped before it was queued",
+                          MakeTraceSourceAccessor(&P2pEthernetNetDevice::m_macTxDropTrace),
+                          "ns3::Packet::TracedCallback")
+          .AddTraceSource("MacPromiscRx",
+                          "A frame handed up to the promiscuous receiver",
+                          MakeTraceSourceAccessor(&P2pEthernetNetDevice::m_macPromiscRxTrace),
+                          "ns3::Packet::TracedCallback")
+          .AddTraceSource("MacRx",
+                          "A frame addressed to this device handed up",
+                          MakeTraceSourceAccessor(&P2pEthernetNetDevice::m_macRxTrace),
+                          "ns3::Packet::TracedCallback")
+          .AddTraceSource("PhyTxBegin",
+                          "Serialization of a frame started",
+                          MakeTraceSourceAccessor(&P2pEthernetNetDevice::m_phyTxBeginTrace),
+                          "ns3::Packet::TracedCallback")
+          .AddTraceSource("PhyTxEnd",
+                          "Serialization of a frame finished",
+                          MakeTraceSourceAccessor(&P2pEthernetNetDevice::m_phyTxEndTrace),
+                          "ns3::Packet::TracedCallback")
+          .AddTraceSource("PhyRxEnd",
+                          "A frame arrived from the channel",
+                          MakeTraceSourceAccessor(&P2pEthernetNetDevice::m_phyRxEndTrace),
+                          "ns3::Packet::TracedCallback")
+          .AddTraceSource("PhyRxDrop",
+                          "A frame lost to the error model or to a down link",
+                          MakeTraceSourceAccessor(&P2pEthernetNetDevice::m_phyRxDropTrace),
+                          "ns3::Packet::TracedCallback");
+  return tid;
+}
+
+P2pEthernetNetDevice::P2pEthernetNetDevice()
+    : m_ifIndex(0), m_mtu(1500), m_linkUp(false), m_transmitting(false) {
+  NS_LOG_FUNCTION(this);
+}
+
+void P2pEthernetNetDevice::DoDispose() {
+  m_node = nullptr;
+  m_channel = nullptr;
+  m_queue = nullptr;
+  m_receiveErrorModel = nullptr;
+  m_currentPkt = nullptr;
+  m_rxCallback.Nullify();
+  m_promiscRxCallback.Nullify();
+  NetDevice::DoDispose();
+}
+
+bool P2pEthernetNetDevice::Attach(Ptr<P2pEthernetChannel> channel) {
+  m_channel = channel;
+  m_channel->Attach(this);
+  if (!m_queue) {
+    m_queue = CreateObject<DropTailQueue<Packet>>();
+  }
+  m_linkUp = true;
+  m_linkChangeCallbacks();
+  return true;
+}
+
+void P2pEthernetNetDevice::SetDataRate(DataRate bps) {
+  m_bps = bps;
+}
+
+void P2pEthernetNetDevice::SetQueue(Ptr<Queue<Packet>> queue) {
+  m_queue = queue;
+}
+
+void P2pEthernetNetDevice::SetReceiveErrorModel(Ptr<ErrorModel> em) {
+  m_receiveErrorModel = em;
+}
+
+void P2pEthernetNetDevice::SetLinkUp(bool up) {
+  NS_LOG_FUNCTION(this << up);
+  if (up == m_linkUp) {
+    return;
+  }
+  m_linkUp = up;
+  if (!up) {
+    // The frame being serialized still completes, but the peer drops it.
+    m_queue->Flush();
+  }
+  m_linkChangeCallbacks();
+}
+
+bool P2pEthernetNetDevice::SendFrom(Ptr<Packet> packet,
+                                    const Address& source,
+                                    const Address& dest,
+                                    uint16_t protocolNumber) {
+  NS_LOG_FUNCTION(this << packet << source << dest << protocolNumber);
+  if (!m_linkUp) {
+    m_macTxDropTrace(packet);
+    return false;
+  }
+
+  EthernetHeader header(false);
+  header.SetSource(Mac48Address::ConvertFrom(source));
+  header.SetDestination(Mac48Address::ConvertFrom(dest));
+  header.SetLengthType(protocolNumber);
+  packet->AddHeader(header);
+
+  m_macTxTrace(packet);
+  if (!m_queue->Enqueue(packet)) {
+    m_macTxDropTrace(packet);
+    return false;
+  }
+  if (!m_transmitting) {
+    StartTransmission();
+  }
+  return true;
+}
+
+bool P2pEthernetNetDevice::Send(Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber) {
+  return SendFrom(packet, m_address, dest, protocolNumber);
+}
+
+void P2pEthernetNetDevice::StartTransmission() {
+  m_currentPkt = m_queue->Dequeue();
+  if (!m_currentPkt) {
+    m_transmitting = false;
+    return;
+  }
+  m_transmitting = true;
+  m_phyTxBeginTrace(m_currentPkt);
+  Time txTime = m_bps.CalculateBytesTxTime(m_currentPkt->GetSize());
+  m_channel->TransmitStart(m_currentPkt, this, txTime);
+  Simulator::Schedule(txTime + m_interframeGap, &P2pEthernetNetDevice::TransmitComplete, this);
+}
+
+void P2pEthernetNetDevice::TransmitComplete() {
+  m_phyTxEndTrace(m_currentPkt);
+  m_currentPkt = nullptr;
+  StartTransmission();
+}
+
+void P2pEthernetNetDevice::Receive(Ptr<Packet> packet) {
+  NS_LOG_FUNCTION(this << packet);
+  if (!m_linkUp || (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt(packet))) {
+    m_phyRxDropTrace(packet);
+    return;
+  }
+  m_phyRxEndTrace(packet);
+
+  Ptr<Packet> originalPacket = packet->Copy();
+  EthernetHeader header(false);
+  packet->RemoveHeader(header);
+  Mac48Address to = header.GetDestination();
+
+  PacketType packetType;
+  if (to.IsBroadcast()) {
+    packetType = NetDevice::PACKET_BROADCAST;
+  } else if (to.IsGroup()) {
+    packetType = NetDevice::PACKET_MULTICAST;
+  } else if (to == m_address) {
+    packetType = NetDevice::PACKET_HOST;
+  } else {
+    packetType = NetDevice::PACKET_OTHERHOST;
+  }
+
+  if (!m_promiscRxCallback.IsNull()) {
+    m_macPromiscRxTrace(originalPacket);
+    m_promiscRxCallback(this, packet, header.GetLengthType(), header.GetSource(), to, packetType);
+  }
+  if (packetType != NetDevice::PACKET_OTHERHOST && !m_rxCallback.IsNull()) {
+    m_macRxTrace(originalPacket);
+    m_rxCallback(this, packet, header.GetLengthType(), header.GetSource());
+  }
+}
+
+void P2pEthernetNetDevice::SetIfIndex(const uint32_t index) {
+  m_ifIndex = index;
+}
+
+uint32_t P2pEthernetNetDevice::GetIfIndex() const {
+  return m_ifIndex;
+}
+
+Ptr<Channel> P2pEthernetNetDevice::GetChannel() const {
+  return m_channel;
+}
+
+void P2pEthernetNetDevice::SetAddress(Address address) {
+  m_address = Mac48Address::ConvertFrom(address);
+}
+
+Address P2pEthernetNetDevice::GetAddress() const {
+  return m_address;
+}
+
+bool P2pEthernetNetDevice::SetMtu(const uint16_t mtu) {
+  m_mtu = mtu;
+  return true;
+}
+
+uint16_t P2pEthernetNetDevice::GetMtu() const {
+  return m_mtu;
+}
+
+bool P2pEthernetNetDevice::IsLinkUp() const {
+  return m_linkUp;
+}
+
+void P2pEthernetNetDevice::AddLinkChangeCallback(Callback<void> callback) {
+  m_linkChangeCallbacks.ConnectWithoutContext(callback);
+}
+
+bool P2pEthernetNetDevice::IsBroadcast() const {
+  return true;
+}
+
+Address P2pEthernetNetDevice::GetBroadcast() const {
+  return Mac48Address::GetBroadcast();
+}
+
+bool P2pEthernetNetDevice::IsMulticast() const {
+  return true;
+}
+
+Address P2pEthernetNetDevice::GetMulticast(Ipv4Address multicastGroup) const {
+  return Mac48Address::GetMulticast(multicastGroup);
+}
+
+Address P2pEthernetNetDevice::GetMulticast(Ipv6Address addr) const {
+  return Mac48Address::GetMulticast(addr);
+}
+
+bool P2pEthernetNetDevice::IsBridge() const {
+  return false;
+}
+
+bool P2pEthernetNetDevice::IsPointToPoint() const {
+  return false;
+}
+
+Ptr<Node> P2pEthernetNetDevice::GetNode() const {
+  return m_node;
+}
+
+void P2pEthernetNetDevice::SetNode(Ptr<Node> node) {
+  m_node = node;
+}
+
+bool P2pEthernetNetDevice::NeedsArp() const {
+  return true;
+}
+
+void P2pEthernetNetDevice::SetReceiveCallback(NetDevice::ReceiveCallback cb) {
+  m_rxCallback = cb;
+}
+
+void P2pEthernetNetDevice::SetPromiscReceiveCallback(NetDevice::PromiscReceiveCallback cb) {
+  m_promiscRxCallback = cb;
+}
+
+bool P2pEthernetNetDevice::SupportsSendFrom() const {
+  return true;
+}
+
+}  // namespace ns3
@@ -0,0 +1,115 @@
+#ifndef ZENOH_SIM_P2P_ETHERNET_NET_DEVICE_H
+#define ZENOH_SIM_P2P_ETHERNET_NET_DEVICE_H
+
+#include "ns3/data-rate.h"
+#include "ns3/error-model.h"
+#include "ns3/mac48-address.h"
+#include "ns3/net-device.h"
+#include "ns3/nstime.h"
+#include "ns3/queue.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+class P2pEthernetChannel;
+
+/**
+ * Full-duplex point-to-point device that keeps Ethernet framing.
+ *
+ * ns-3's PointToPointNetDevice uses PPP framing and cannot SendFrom, so it
+ * cannot sit behind a TapBridge in UseBridge mode: the container MACs would
+ * be lost. This device carries the original source/destination MACs like
+ * CsmaNetDevice does, but each direction has its own transmitter, so data
+ * and ACKs do not contend and there is no CSMA backoff.
+ *
+ * The trace sources use the CsmaNetDevice names, so code hooking device
+ * traces works for both link types.
+ */
+class P2pEthernetNetDevice : public NetDevice {
+ public:
+  static TypeId GetTypeId();
+
+  P2pEthernetNetDevice();
+
+  bool Attach(Ptr<P2pEthernetChannel> channel);
+  /// Called by the channel when a frame has fully arrived.
+  void Receive(Ptr<Packet> packet);
+
+  void SetDataRate(DataRate bps);
+  DataRate GetDataRate() const { return m_bps; }
+  void SetQueue(Ptr<Queue<Packet>> queue);
+  Ptr<Queue<Packet>> GetQueue() const { return m_queue; }
+  /// Frames the error model marks as corrupt are dropped on receive (PhyRxDrop).
+  void SetReceiveErrorModel(Ptr<ErrorModel> em);
+  /**
+   * Pulls or reconnects the cable at this end. While down, queued frames are
+   * flushed and everything sent or received is dropped.
+   */
+  void SetLinkUp(bool up);
+
+  // NetDevice
+  void SetIfIndex(const uint32_t index) override;
+  uint32_t GetIfIndex() const override;
+  Ptr<Channel> GetChannel() const override;
+  void SetAddress(Address address) override;
+  Address GetAddress() const override;
+  bool SetMtu(const uint16_t mtu) override;
+  uint16_t GetMtu() const override;
+  bool IsLinkUp() const override;
+  void AddLinkChangeCallback(Callback<void> callback) override;
+  bool IsBroadcast() const override;
+  Address GetBroadcast() const override;
+  bool IsMulticast() const override;
+  Address GetMulticast(Ipv4Address multicastGroup) const override;
+  Address GetMulticast(Ipv6Address addr) const override;
+  bool IsBridge() const override;
+  bool IsPointToPoint() const override;
+  bool Send(Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber) override;
+  bool SendFrom(Ptr<Packet> packet,
+                const Address& source,
+                const Address& dest,
+                uint16_t protocolNumber) override;
+  Ptr<Node> GetNode() const override;
+  void SetNode(Ptr<Node> node) override;
+  bool NeedsArp() const override;
+  void SetReceiveCallback(NetDevice::ReceiveCallback cb) override;
+  void SetPromiscReceiveCallback(NetDevice::PromiscReceiveCallback cb) override;
+  bool SupportsSendFrom() const override;
+
+ protected:
+  void DoDispose() override;
+
+ private:
+  void StartTransmission();
+  void TransmitComplete();
+
+  Ptr<Node> m_node;
+  Ptr<P2pEthernetChannel> m_channel;
+  Ptr<Queue<Packet>> m_queue;
+  Ptr<ErrorModel> m_receiveErrorModel;
+  Mac48Address m_address;
+  DataRate m_bps;
+  Time m_interframeGap;
+  uint32_t m_ifIndex;
+  uint16_t m_mtu;
+  bool m_linkUp;
+  bool m_transmitting;
+  Ptr<Packet> m_currentPkt;
+
+  NetDevice::ReceiveCallback m_rxCallback;
+  NetDevice::PromiscReceiveCallback m_promiscRxCallback;
+  TracedCallback<> m_linkChangeCallbacks;
+
+  TracedCallback<Ptr<const Packet>> m_macTxTrace;
+  TracedCallback<Ptr<const Packet>> m_macTxDropTrace;
+  TracedCallback<Ptr<const Packet>> m_macPromiscRxTrace;
+  TracedCallback<Ptr<const Packet>> m_macRxTrace;
+  TracedCallback<Ptr<const Packet>> m_phyTxBeginTrace;
+  TracedCallback<Ptr<const Packet>> m_phyTxEndTrace;
+  TracedCallback<Ptr<const Packet>> m_phyRxEndTrace;
+  TracedCallback<Ptr<const Packet>> m_phyRxDropTrace;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_P2P_ETHERNET_NET_DEVICE_H
@@ -0,0 +1,199 @@
+#include "path-observer.h"
+
+#include "ns3/callback.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("PathObserver");
+
+PathObserver::PathObserver(EmulatedTopology& topology, const std::string& outputDir)
+    : m_topology(topology),
+      m_outputDir(outputDir),
+      m_window(MilliSeconds(500)),
+      m_minRateKbps(64),
+      m_holdWindows(2),
+      m_parser(2 * topology.GetLinks().size(), 1024, kMaxKeys) {}
+
+void PathObserver::SetWindow(Time window) {
+  m_window = window;
+}
+
+void PathObserver::SetMinRate(double kbps) {
+  m_minRateKbps = kbps;
+}
+
+void PathObserver::SetHoldWindows(uint32_t windows) {
+  m_holdWindows = std::max<uint32_t>(windows, 1);
+}
+
+std::string PathObserver::DirectionName(uint32_t dir) const {
+  const EmulatedLink& link = m_topology.GetLinks()[dir / 2];
+  uint32_t side = dir % 2;
+  return link.name + ":" + link.ends[side].nodeId + ">" + link.ends[1 - side].nodeId;
+}
+
+std::string PathObserver::Join(const std::vector<uint32_t>& dirs) const {
+  std::string out;
+  for (uint32_t dir : dirs) {
+    out += (out.empty() ? "" : " ") + DirectionName(dir);
+  }
+  return out;
+}
+
+void PathObserver::OnTx(Direction* dir, Ptr<const Packet> packet) {
+  // Only the headers are copied unless the parser has to look at the payload.
+  PathObserver* self = dir->observer;
+  uint32_t size = packet->GetSize();
+  uint32_t captured = packet->CopyData(self->m_frame.data(), std::min(size, kCapture));
+  if (!self->m_parser.OnFrame(dir->index, self->m_frame.data(), captured, size)) {
+    captured = packet->CopyData(self->m_frame.data(),
+                                std::min<uint32_t>(size, self->m_frame.size()));
+    self->m_parser.OnFrame(dir->index, self->m_frame.data(), captured, captured);
+  }
+}
+
+void PathObserver::Start() {
+  uint32_t n = m_parser.GetNDirections();
+  m_frame.assign(65536, 0);
+  m_directions.resize(n);
+  m_carrying.assign(static_cast<size_t>(kMaxKeys) * n, 0);
+  m_idle.assign(m_carrying.size(), 0);
+  m_total.assign(m_carrying.size(), 0);
+  m_keys.assign(kMaxKeys, KeyState{false, 0, 0, 0});
+  m_added.reserve(n);
+  m_removed.reserve(n);
+  m_now.reserve(n);
+
+  uint32_t i = 0;
+  for (auto& link : m_topology.GetLinks()) {
+    for (auto& end : link.ends) {
+      m_directions[i] = Direction{this, i};
+      end.device->TraceConnectWithoutContext(
+          "MacTx", MakeBoundCallback(&PathObserver::OnTx, &m_directions[i]));
+      ++i;
+    }
+  }
+
+  m_rates.open(m_outputDir + "/path_rates.csv");
+  m_rates << "sim_s,key,link,from,to,mbps\n";
+  m_events.open(m_outputDir + "/path_events.csv");
+  m_events << "sim_s,wall_time,key,kind,links,added,removed\n";
+  Simulator::Schedule(m_window, &PathObserver::Window, this);
+}
+
+void PathObserver::Window() {
+  double now = Simulator::Now().GetSeconds();
+  double seconds = m_window.GetSeconds();
+  uint64_t minBytes = static_cast<uint64_t>(m_minRateKbps * 1000 / 8 * seconds);
+  uint32_t nDirs = m_parser.GetNDirections();
+
+  for (uint16_t key = 0; key < m_parser.GetNKeys(); ++key) {
+    m_added.clear();
+    m_removed.clear();
+    m_now.clear();
+    for (uint32_t dir = 0; dir < nDirs; ++dir) {
+      size_t cell = static_cast<size_t>(key) * nDirs + dir;
+      uint64_t bytes = m_parser.TakeBytes(key, dir);
+      m_total[cell] += bytes;
+      if (bytes > 0) {
+        const EmulatedLink& link = m_topology.GetLinks()[dir / 2];
+        m_rates << now << "," << m_parser.GetKey(key) << "," << link.name << ","
+                << link.ends[dir % 2].nodeId << "," << link.ends[1 - dir % 2].nodeId << ","
+                << bytes * 8 / seconds / 1e6 << "\n";
+      }
+      if (key == ZenohFlowParser::kControlKey) {
+        continue;
+      }
+      if (bytes > 0 && bytes >= minBytes) {
+        m_idle[cell] = 0;
+        if (!m_carrying[cell]) {
+          m_carrying[cell] = 1;
+          m_added.push_back(dir);
+        }
+      } else if (m_carrying[cell] && ++m_idle[cell] >= m_holdWindows) {
+        m_carrying[cell] = 0;
+        m_removed.push_back(dir);
+      }
+      if (m_carrying[cell]) {
+        m_now.push_back(dir);
+      }
+    }
+    if (m_added.empty() && m_removed.empty()) {
+      continue;
+    }
+
+    KeyState& state = m_keys[key];
+    const char* kind = "reroute";
+    if (!state.active) {
+      kind = "start";
+      if (state.firstSeen == 0) {
+        state.firstSeen = now;
+      }
+    } else if (m_now.empty()) {
+      kind = "stop";
+    } else if (m_added.empty()) {
+      kind = "drop";  // the tail end of a reroute once the old path idles out
+    } else {
+      ++state.reroutes;
+    }
+    state.active = !m_now.empty();
+    state.lastChange = now;
+
+    double wall =
+        std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    m_events << now << "," << std::fixed << wall << std::defaultfloat << ","
+             << m_parser.GetKey(key) << "," << kind << "," << Join(m_now) << "," << Join(m_added)
+             << "," << Join(m_removed) << std::endl;
+    NS_LOG_UNCOND("t=" << now << "s " << m_parser.GetKey(key) << " " << kind << ": "
+                       << Join(m_now));
+  }
+  m_rates.flush();
+  Simulator::Schedule(m_window, &PathObserver::Window, this);
+}
+
+void PathObserver::Finish() {
+  m_rates.close();
+  m_events.close();
+
+  const ZenohFlowParser::Stats& stats = m_parser.GetStats();
+  uint32_t nDirs = m_parser.GetNDirections();
+  std::ofstream os(m_outputDir + "/path_summary.json");
+  os << "{\n  \"window_ms\": " << m_window.GetMilliSeconds()
+     << ",\n  \"min_rate_kbps\": " << m_minRateKbps << ",\n  \"parser\": {\"frames\": "
+     << stats.frames << ", \"streams\": " << stats.streams << ", \"resyncs\": " << stats.resyncs
+     << ", \"unparsed_bytes\": " << stats.unparsedBytes
+     << ", \"stream_table_full\": " << stats.streamTableFull
+     << ", \"key_table_full\": " << stats.keyTableFull << "},\n  \"keys\": [";
+  const char* sep = "\n";
+  for (uint16_t key = 0; key < m_parser.GetNKeys(); ++key) {
+    const KeyState& state = m_keys[key];
+    os << sep << "    {\"key\": \"" << m_parser.GetKey(key) << "\", \"reroutes\": "
+       << state.reroutes << ", \"first_seen_s\": " << state.firstSeen
+       << ", \"last_change_s\": " << state.lastChange << ", \"bytes\": {";
+    const char* inner = "";
+    for (uint32_t dir = 0; dir < nDirs; ++dir) {
+      uint64_t bytes = m_total[static_cast<size_t>(key) * nDirs + dir];
+      if (bytes > 0) {
+        os << inner << "\"" << DirectionName(dir) << "\": " << bytes;
+        inner = ", ";
+      }
+    }
+    os << "}}";
+    sep = ",\n";
+  }
+  os << "\n  ]\n}\n";
+
+  uint64_t reroutes = 0;
+  for (const KeyState& state : m_keys) {
+    reroutes += state.reroutes;
+  }
+  NS_LOG_UNCOND("paths: " << m_parser.GetNKeys() - 2 << " keys, " << reroutes << " reroutes, "
+                          << stats.streams << " TCP streams");
+}
+
+}  // namespace ns3
@@ -0,0 +1,88 @@
+#ifndef ZENOH_SIM_PATH_OBSERVER_H
+#define ZENOH_SIM_PATH_OBSERVER_H
+
+#include "emulated-topology.h"
+#include "zenoh-flow-parser.h"
+
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Passive observer of which links carry the publications of each key
+ * expression.
+ *
+ * Every frame a TAP hands to a link (MacTx) goes through a ZenohFlowParser,
+ * which attributes its TCP payload to the key of the PUSH it belongs to.
+ * Every window the observer turns the bytes per (key, link direction) into
+ * rates in path_rates.csv. A direction carries a key while it sees at least
+ * the minimum rate; it stops carrying it after `hold` windows below. Whenever
+ * the set of carrying directions of a key changes, an event goes to
+ * path_events.csv with simulation and wall-clock time, so it can be lined up
+ * with link_events.csv and the zenohd logs: start, reroute (a new direction
+ * joins), drop (a direction idles out) or stop. The resolution is one window.
+ * path_summary.json has the reroute (flap) count of every key.
+ */
+class PathObserver {
+ public:
+  PathObserver(EmulatedTopology& topology, const std::string& outputDir);
+
+  void SetWindow(Time window);
+  void SetMinRate(double kbps);
+  void SetHoldWindows(uint32_t windows);
+
+  /// Hooks MacTx of every link end and starts the windows.
+  void Start();
+  void Finish();
+
+ private:
+  static constexpr uint32_t kMaxKeys = 1024;
+  static constexpr uint32_t kCapture = 128;  ///< enough for Ethernet, IPv4 and TCP headers
+
+  struct Direction {
+    PathObserver* observer;
+    uint32_t index;
+  };
+
+  struct KeyState {
+    bool active;
+    uint64_t reroutes;
+    double firstSeen;
+    double lastChange;
+  };
+
+  static void OnTx(Direction* dir, Ptr<const Packet> packet);
+  void Window();
+  std::string DirectionName(uint32_t dir) const;
+  std::string Join(const std::vector<uint32_t>& dirs) const;
+
+  EmulatedTopology& m_topology;
+  std::string m_outputDir;
+  Time m_window;
+  double m_minRateKbps;
+  uint32_t m_holdWindows;
+
+  ZenohFlowParser m_parser;
+  std::vector<Direction> m_directions;
+  std::vector<uint8_t> m_frame;
+
+  std::vector<uint8_t> m_carrying;  ///< [key * directions + dir]
+  std::vector<uint8_t> m_idle;      ///< windows below the minimum rate, same layout
+  std::vector<uint64_t> m_total;    ///< bytes over the whole run, same layout
+  std::vector<KeyState> m_keys;
+  std::vector<uint32_t> m_added;
+  std::vector<uint32_t> m_removed;
+  std::vector<uint32_t> m_now;
+
+  std::ofstream m_rates;
+  std::ofstream m_events;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_PATH_OBSERVER_H
@@ -0,0 +1,250 @@
+#include "priority-link-queue.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("PriorityLinkQueue");
+
+NS_OBJECT_ENSURE_REGISTERED(PriorityLinkQueue);
+
+namespace {
+
+const uint16_t kEtherTypeIpv4 = 0x0800;
+const uint16_t kEtherTypeVlan = 0x8100;
+const uint8_t kProtoTcp = 6;
+
+}  // namespace
+
+TypeId PriorityLinkQueue::GetTypeId() {
+  static TypeId tid = TypeId("ns3::PriorityLinkQueue")
+                          .SetParent<Queue<Packet>>()
+                          .AddConstructor<PriorityLinkQueue>();
+  return tid;
+}
+
+PriorityLinkQueue::PriorityLinkQueue()
+    : m_rr(0), m_rrGranted(false), m_refillNs(0), m_parser(1, 64, 2), m_frame(65536) {
+  PriorityQueueParams params;
+  params.weights = {0};
+  std::fill(std::begin(params.dscpClass), std::end(params.dscpClass), 0);
+  std::fill(std::begin(params.priorityClass), std::end(params.priorityClass), 0);
+  SetParams(params);
+}
+
+PriorityLinkQueue::~PriorityLinkQueue() {}
+
+void PriorityLinkQueue::SetParams(const PriorityQueueParams& params) {
+  NS_ABORT_MSG_IF(params.weights.empty(), "PriorityLinkQueue needs at least one class");
+  NS_ABORT_MSG_IF(GetNPackets() > 0, "PriorityLinkQueue classes changed while frames are queued");
+  m_params = params;
+  m_classes.assign(params.weights.size(), Class());
+  for (uint32_t c = 0; c < m_classes.size(); ++c) {
+    Class& k = m_classes[c];
+    k.weight = params.weights[c];
+    uint64_t rate = c < params.rateBps.size() ? params.rateBps[c] : 0;
+    k.rateBytesPerNs = rate / 8e9;
+    k.tokens = params.burstBytes;
+    k.bytes = 0;
+    k.deficit = 0;
+  }
+  for (uint8_t& c : m_params.dscpClass) {
+    c = std::min<uint32_t>(c, m_classes.size() - 1);
+  }
+  for (uint8_t& c : m_params.priorityClass) {
+    c = std::min<uint32_t>(c, m_classes.size() - 1);
+  }
+  m_rr = 0;
+  m_rrGranted = false;
+  m_refillNs = Simulator::Now().GetNanoSeconds();
+  // The per-class limits do the dropping; the base limit only has to hold them all.
+  SetMaxSize(QueueSize(QueueSizeUnit::BYTES, m_classes.size() * params.limitBytes));
+}
+
+void PriorityLinkQueue::SetRates(const std::vector<uint64_t>& rateBps) {
+  // Tokens earned so far still count at the old rates.
+  Refill(Simulator::Now().GetNanoSeconds());
+  m_params.rateBps = rateBps;
+  for (uint32_t c = 0; c < m_classes.size(); ++c) {
+    uint64_t rate = c < rateBps.size() ? rateBps[c] : 0;
+    m_classes[c].rateBytesPerNs = rate / 8e9;
+  }
+}
+
+uint32_t PriorityLinkQueue::Classify(Ptr<const Packet> packet) {
+  uint32_t size = packet->GetSize();
+  uint32_t captured = packet->CopyData(m_frame.data(), std::min(size, kCapture));
+  const uint8_t* f = m_frame.data();
+  uint32_t l3 = 14;
+  uint16_t type = captured >= 14 ? f[12] << 8 | f[13] : 0;
+  if (type == kEtherTypeVlan && captured >= 18) {
+    type = f[16] << 8 | f[17];
+    l3 = 18;
+  }
+  if (type != kEtherTypeIpv4 || captured < l3 + 20) {
+    return 0;
+  }
+  const uint8_t* ip = f + l3;
+  if (m_params.classifier == PriorityQueueParams::DSCP) {
+    return m_params.dscpClass[ip[1] >> 2];
+  }
+
+  uint32_t ihl = (ip[0] & 0x0f) * 4;
+  uint32_t ipLen = ip[2] << 8 | ip[3];
+  if (ip[9] != kProtoTcp) {
+    return m_params.priorityClass[5];
+  }
+  if (captured < l3 + ihl + 20) {
+    return 0;
+  }
+  uint32_t tcpHeader = (ip[ihl + 12] >> 4) * 4;
+  if (ipLen <= ihl + tcpHeader) {
+    return 0;  // pure ACK, SYN or FIN
+  }
+  if (!m_parser.OnFrame(0, m_frame.data(), captured, size)) {
+    captured = packet->CopyData(m_frame.data(), std::min<uint32_t>(size, m_frame.size()));
+    m_parser.OnFrame(0, m_frame.data(), captured, captured);
+  }
+  uint8_t priority = m_parser.GetFramePriority();
+  return m_params.priorityClass[priority == ZenohFlowParser::kNoPriority ? 5 : priority];
+}
+
+void PriorityLinkQueue::Refill(int64_t nowNs) {
+  int64_t elapsed = nowNs - m_refillNs;
+  m_refillNs = nowNs;
+  for (Class& c : m_classes) {
+    if (c.rateBytesPerNs > 0) {
+      c.tokens = std::min<double>(m_params.burstBytes, c.tokens + elapsed * c.rateBytesPerNs);
+    }
+  }
+}
+
+bool PriorityLinkQueue::Conforms(const Class& c) const {
+  return c.rateBytesPerNs == 0 || c.tokens >= c.entries.front().size;
+}
+
+uint32_t PriorityLinkQueue::Pick(bool conforming) {
+  uint32_t n = m_classes.size();
+  for (uint32_t c = 0; c < n; ++c) {
+    const Class& k = m_classes[c];
+    if (k.weight == 0 && !k.entries.empty() && (!conforming || Conforms(k))) {
+      return c;
+    }
+  }
+  // A few rounds grant every weighted class enough quantum for any frame.
+  for (uint32_t visits = 0; visits < 4 * n; ++visits) {
+    Class& k = m_classes[m_rr];
+    if (k.weight > 0) {
+      if (k.entries.empty()) {
+        k.deficit = 0;
+      } else if (!conforming || Conforms(k)) {
+        if (!m_rrGranted) {
+          k.deficit += k.weight * kQuantum;
+          m_rrGranted = true;
+        }
+        if (k.entries.front().size <= k.deficit) {
+          return m_rr;
+        }
+      }
+    }
+    m_rr = (m_rr + 1) % n;
+    m_rrGranted = false;
+  }
+  return kNone;
+}
+
+bool PriorityLinkQueue::Enqueue(Ptr<Packet> packet) {
+  NS_LOG_FUNCTION(this << packet);
+  Class& k = m_classes[Classify(packet)];
+  uint32_t size = packet->GetSize();
+  if (k.bytes + size > m_params.limitBytes) {
+    ++k.stats.drops;
+    k.stats.dropBytes += size;
+    DropBeforeEnqueue(packet);
+    return false;
+  }
+  if (!DoEnqueue(end(), packet)) {
+    ++k.stats.drops;
+    k.stats.dropBytes += size;
+    return false;
+  }
+  k.bytes += size;
+  k.entries.push_back(Entry{std::prev(end()), Simulator::Now().GetNanoSeconds(), size});
+  return true;
+}
+
+Ptr<Packet> PriorityLinkQueue::Dequeue() {
+  NS_LOG_FUNCTION(this);
+  if (IsEmpty()) {
+    return nullptr;
+  }
+  int64_t now = Simulator::Now().GetNanoSeconds();
+  Refill(now);
+  bool overRate = false;
+  uint32_t c = Pick(true);
+  if (c == kNone) {
+    overRate = true;
+    c = Pick(false);
+  }
+  if (c == kNone) {
+    c = 0;
+    while (m_classes[c].entries.empty()) {
+      ++c;
+    }
+  }
+
+  Class& k = m_classes[c];
+  Entry entry = k.entries.front();
+  k.entries.pop_front();
+  k.bytes -= entry.size;
+  if (k.weight > 0) {
+    k.deficit = std::max<int64_t>(0, k.deficit - entry.size);
+  }
+  if (k.rateBytesPerNs > 0) {
+    k.tokens = std::max(0.0, k.tokens - entry.size);
+  }
+  ++k.stats.packets;
+  k.stats.bytes += entry.size;
+  k.stats.overRate += overRate;
+  k.stats.delay.Add(now - entry.enqueueNs);
+  return DoDequeue(entry.it);
+}
+
+Ptr<Packet> PriorityLinkQueue::Remove() {
+  NS_LOG_FUNCTION(this);
+  for (Class& k : m_classes) {
+    if (!k.entries.empty()) {
+      Entry entry = k.entries.front();
+      k.entries.pop_front();
+      k.bytes -= entry.size;
+      return DoRemove(entry.it);
+    }
+  }
+  return nullptr;
+}
+
+Ptr<const Packet> PriorityLinkQueue::Peek() const {
+  // The frame of the most urgent class; Dequeue may pick another one when
+  // token buckets or the round robin decide otherwise.
+  for (const Class& k : m_classes) {
+    if (!k.entries.empty()) {
+      return DoPeek(k.entries.front().it);
+    }
+  }
+  return nullptr;
+}
+
+void PriorityLinkQueue::DoDispose() {
+  for (Class& k : m_classes) {
+    k.entries.clear();
+    k.bytes = 0;
+  }
+  Queue<Packet>::DoDispose();
+}
+
+}  // namespace ns3
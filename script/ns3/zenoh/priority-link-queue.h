@@ -0,0 +1,121 @@
+#ifndef ZENOH_SIM_PRIORITY_LINK_QUEUE_H
+#define ZENOH_SIM_PRIORITY_LINK_QUEUE_H
+
+#include "log-histogram.h"
+#include "zenoh-flow-parser.h"
+
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+
+#include <deque>
+#include <vector>
+
+namespace ns3 {
+
+/// How a PriorityLinkQueue sorts frames into classes.
+struct PriorityQueueParams {
+  enum Classifier { DSCP, ZENOH };
+
+  Classifier classifier = ZENOH;
+  /// One entry per class, most urgent first. 0 serves the class by strict
+  /// priority, otherwise it is its WDRR weight.
+  std::vector<uint32_t> weights;
+  uint8_t dscpClass[64];     ///< class of every IP DSCP value
+  uint8_t priorityClass[8];  ///< class of every Zenoh priority (0 Control ... 7 Background)
+  /// Token bucket rate of every class in bit/s, 0: unlimited.
+  std::vector<uint64_t> rateBps;
+  uint32_t burstBytes = 16384;  ///< token bucket depth
+  uint32_t limitBytes = 65536;  ///< bytes queued per class before it drops
+};
+
+/**
+ * Egress queue of a link end that serves several classes instead of one
+ * FIFO: strict priority classes first, in order, then the weighted classes
+ * by deficit round robin (a quantum of weight * 1600 bytes per round).
+ *
+ * A class whose token bucket is empty yields to every class that conforms
+ * to its rate. It is still served when nothing else is queued, so the link
+ * never idles with frames waiting; those frames count as over rate.
+ *
+ * Frames are classified by the DSCP of their IPv4 header, or by the Zenoh
+ * priority of the batches they carry (the QoS extension of FRAME and
+ * FRAGMENT, read by a ZenohFlowParser). A TCP segment carrying several
+ * batches takes the most urgent one. In Zenoh mode, pure TCP ACKs and
+ * non-IPv4 frames (ARP) go to the first class, and other IPv4 traffic is
+ * classified as Zenoh Data.
+ *
+ * Each class drops frames that would take it over `limitBytes`. Drops,
+ * queue delays and the frames sent past the token bucket are counted per
+ * class.
+ */
+class PriorityLinkQueue : public Queue<Packet> {
+ public:
+  static TypeId GetTypeId();
+
+  /// Per-class counters.
+  struct ClassStats {
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t drops = 0;
+    uint64_t dropBytes = 0;
+    uint64_t overRate = 0;  ///< frames sent with the token bucket empty
+    LogHistogram delay;     ///< ns between Enqueue and Dequeue
+  };
+
+  PriorityLinkQueue();
+  ~PriorityLinkQueue() override;
+
+  /// Sets the classes; call before the first Enqueue.
+  void SetParams(const PriorityQueueParams& params);
+  /// Changes the token bucket rates (bit/s per class) of a running queue, keeping its tokens.
+  void SetRates(const std::vector<uint64_t>& rateBps);
+  uint32_t GetNClasses() const { return m_classes.size(); }
+  const ClassStats& GetClassStats(uint32_t c) const { return m_classes[c].stats; }
+
+  bool Enqueue(Ptr<Packet> packet) override;
+  Ptr<Packet> Dequeue() override;
+  Ptr<Packet> Remove() override;
+  Ptr<const Packet> Peek() const override;
+
+ protected:
+  void DoDispose() override;
+
+ private:
+  static constexpr uint32_t kQuantum = 1600;
+  static constexpr uint32_t kCapture = 128;
+  static constexpr uint32_t kNone = ~0u;
+
+  struct Entry {
+    ConstIterator it;
+    int64_t enqueueNs;
+    uint32_t size;
+  };
+
+  struct Class {
+    uint32_t weight;
+    double rateBytesPerNs;  ///< 0: unlimited
+    double tokens;          ///< bytes
+    uint32_t bytes;         ///< queued
+    int64_t deficit;
+    std::deque<Entry> entries;
+    ClassStats stats;
+  };
+
+  uint32_t Classify(Ptr<const Packet> packet);
+  void Refill(int64_t nowNs);
+  bool Conforms(const Class& c) const;
+  uint32_t Pick(bool conforming);
+
+  PriorityQueueParams m_params;
+  std::vector<Class> m_classes;
+  uint32_t m_rr;  ///< weighted class the round robin is at
+  bool m_rrGranted;  ///< m_rr got its quantum this round
+  int64_t m_refillNs;
+
+  ZenohFlowParser m_parser;
+  std::vector<uint8_t> m_frame;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_PRIORITY_LINK_QUEUE_H
@@ -0,0 +1,88 @@
+#include "shard-runner.h"
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sched.h>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("ShardRunner");
+
+std::vector<std::vector<uint32_t>> ShardRunner::Partition(const NetworkConfig& config,
+                                                          uint32_t shards) {
+  shards = std::max<uint32_t>(1, std::min<uint32_t>(shards, config.links.size()));
+  std::vector<uint32_t> order(config.links.size());
+  for (uint32_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&config](uint32_t x, uint32_t y) {
+    return config.links[x].capMbps > config.links[y].capMbps;
+  });
+
+  std::vector<std::vector<uint32_t>> plan(shards);
+  std::vector<double> load(shards, 0);
+  for (uint32_t idx : order) {
+    uint32_t target = std::min_element(load.begin(), load.end()) - load.begin();
+    plan[target].push_back(idx);
+    load[target] += config.links[idx].capMbps;
+  }
+  for (auto& shard : plan) {
+    std::sort(shard.begin(), shard.end());
+  }
+  return plan;
+}
+
+int ShardRunner::Run(uint32_t shards,
+                     const std::string& cpuList,
+                     const std::function<int(uint32_t)>& worker) {
+  std::vector<int> cpus;
+  std::istringstream iss(cpuList);
+  std::string item;
+  while (std::getline(iss, item, ',')) {
+    if (!item.empty()) {
+      cpus.push_back(std::atoi(item.c_str()));
+    }
+  }
+  long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+  std::vector<pid_t> pids;
+  for (uint32_t shard = 0; shard < shards; ++shard) {
+    std::cout.flush();
+    pid_t pid = fork();
+    NS_ABORT_MSG_IF(pid < 0, "fork failed for shard " << shard);
+    if (pid == 0) {
+      int cpu = cpus.empty() ? static_cast<int>(shard % ncpu) : cpus[shard % cpus.size()];
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpu, &set);
+      if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        NS_LOG_WARN("shard " << shard << ": cannot pin to cpu " << cpu);
+      }
+      int code = worker(shard);
+      std::cout.flush();
+      _exit(code);
+    }
+    pids.push_back(pid);
+  }
+
+  int worst = 0;
+  for (uint32_t shard = 0; shard < pids.size(); ++shard) {
+    int status = 0;
+    waitpid(pids[shard], &status, 0);
+    int code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    if (code != 0) {
+      NS_LOG_UNCOND("shard " << shard << " exited with code " << code);
+    }
+    worst = std::max(worst, code);
+  }
+  return worst;
+}
+
+}  // namespace ns3
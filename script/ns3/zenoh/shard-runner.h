@@ -0,0 +1,43 @@
+#ifndef ZENOH_SIM_SHARD_RUNNER_H
+#define ZENOH_SIM_SHARD_RUNNER_H
+
+#include "network-config.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Sharded execution: the emulated links share no ns-3 state (nodes have no
+ * internet stack, each channel is its own L2 segment between two TAPs), so
+ * they can be split across independent emulator processes, each with its own
+ * real-time event loop pinned to its own core. Every shard keeps the same
+ * tap_<node>_<idx> names for the links it owns.
+ */
+class ShardRunner {
+ public:
+  /**
+   * Splits the config's links into at most `shards` groups of link indices,
+   * balancing the summed link capacity (the frame rate a link can generate)
+   * with a longest-processing-time greedy assignment.
+   */
+  static std::vector<std::vector<uint32_t>> Partition(const NetworkConfig& config,
+                                                      uint32_t shards);
+
+  /**
+   * Forks one process per shard and runs `worker(shard)` in it, pinned to the
+   * shard's CPU (`cpuList` like "2,3,4,5", or cores 0..n-1 when empty).
+   * Must be called before the simulator is touched. Returns the highest
+   * worker exit code.
+   */
+  static int Run(uint32_t shards,
+                 const std::string& cpuList,
+                 const std::function<int(uint32_t)>& worker);
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_SHARD_RUNNER_H
@@ -0,0 +1,152 @@
+#include "tap-readiness.h"
+
+#include "ns3/callback.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("TapReadiness");
+
+TapReadiness::TapReadiness(EmulatedTopology& topology, const std::string& outputDir)
+    : m_topology(topology),
+      m_outputDir(outputDir),
+      m_readyFile(outputDir + "/ready.json"),
+      m_origin(std::chrono::steady_clock::now()),
+      m_originWall(std::chrono::duration<double>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count()),
+      m_started(false),
+      m_ends(2 * topology.GetLinks().size()),
+      m_readyMs(-1),
+      m_silent(m_ends.size()) {
+  for (uint32_t i = 0; i < m_ends.size(); ++i) {
+    m_ends[i] = End{this, i, -1, -1, -1};
+  }
+}
+
+void TapReadiness::SetReadyFile(const std::string& path) {
+  m_readyFile = path;
+}
+
+void TapReadiness::SetReadyCallback(Callback<void> ready) {
+  m_ready = ready;
+}
+
+double TapReadiness::ElapsedMs() const {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_origin)
+      .count();
+}
+
+void TapReadiness::Attached(uint32_t end) {
+  m_ends[end].attachMs = ElapsedMs();
+}
+
+void TapReadiness::Start() {
+  // A file left over from an earlier run must not release anyone.
+  std::remove(m_readyFile.c_str());
+  uint32_t i = 0;
+  for (auto& link : m_topology.GetLinks()) {
+    for (auto& end : link.ends) {
+      end.device->TraceConnectWithoutContext(
+          "MacTx", MakeBoundCallback(&TapReadiness::OnTx, &m_ends[i]));
+      end.device->TraceConnectWithoutContext(
+          "MacPromiscRx", MakeBoundCallback(&TapReadiness::OnRx, &m_ends[i]));
+      ++i;
+    }
+  }
+  m_started = true;
+  // Events at the same time run in insertion order, so this one runs after
+  // every bridge scheduled so far has attached, once the real-time loop runs.
+  Simulator::ScheduleNow(&TapReadiness::Publish, this);
+}
+
+void TapReadiness::Publish() {
+  m_readyMs = ElapsedMs();
+  if (!m_ready.IsNull()) {
+    m_ready();
+  }
+  uint32_t attached = 0;
+  uint32_t slowest = 0;
+  for (const End& end : m_ends) {
+    if (end.attachMs >= 0) {
+      ++attached;
+      slowest = end.attachMs > m_ends[slowest].attachMs ? end.index : slowest;
+    }
+  }
+  if (attached < m_ends.size()) {
+    NS_LOG_UNCOND("ready: only " << attached << " of " << m_ends.size()
+                                 << " TAPs attached, not writing " << m_readyFile);
+    return;
+  }
+
+  std::string tmp = m_readyFile + ".tmp";
+  {
+    std::ofstream os(tmp);
+    os << std::fixed << std::setprecision(3) << "{\n  \"pid\": " << getpid()
+       << ",\n  \"experiment\": \"" << m_topology.GetConfig().experiment
+       << "\",\n  \"ready_ms\": " << m_readyMs << ",\n  \"ready_wall\": "
+       << m_originWall + m_readyMs / 1000 << ",\n  \"taps\": {";
+    const char* sep = "\n";
+    for (const End& end : m_ends) {
+      const EmulatedLink& link = m_topology.GetLinks()[end.index / 2];
+      os << sep << "    \"" << link.ends[end.index % 2].tapName << "\": {\"link\": \""
+         << link.name << "\", \"attach_ms\": " << end.attachMs
+         << ", \"attach_wall\": " << m_originWall + end.attachMs / 1000 << "}";
+      sep = ",\n";
+    }
+    os << "\n  }\n}\n";
+  }
+  std::rename(tmp.c_str(), m_readyFile.c_str());
+
+  const EmulatedLink& link = m_topology.GetLinks()[slowest / 2];
+  NS_LOG_UNCOND("ready: " << m_ends.size() << " TAPs attached, last "
+                          << link.ends[slowest % 2].tapName << " after "
+                          << m_ends[slowest].attachMs << " ms, forwarding after " << m_readyMs
+                          << " ms, signalled in " << m_readyFile);
+}
+
+void TapReadiness::OnTx(End* end, Ptr<const Packet>) {
+  if (end->firstInMs >= 0) {
+    return;
+  }
+  TapReadiness* self = end->readiness;
+  end->firstInMs = self->ElapsedMs();
+  if (--self->m_silent == 0) {
+    NS_LOG_UNCOND("startup: every TAP has sent a frame after " << end->firstInMs << " ms ("
+                                                              << end->firstInMs - self->m_readyMs
+                                                              << " ms after ready)");
+  }
+}
+
+void TapReadiness::OnRx(End* end, Ptr<const Packet>) {
+  if (end->firstOutMs < 0) {
+    end->firstOutMs = end->readiness->ElapsedMs();
+  }
+}
+
+void TapReadiness::Finish() {
+  if (!m_started) {
+    return;
+  }
+  std::remove(m_readyFile.c_str());
+
+  std::ofstream os(m_outputDir + "/startup.csv");
+  os << "tap,link,attach_ms,first_in_ms,first_out_ms\n";
+  for (const End& end : m_ends) {
+    const EmulatedLink& link = m_topology.GetLinks()[end.index / 2];
+    os << link.ends[end.index % 2].tapName << "," << link.name << "," << end.attachMs << ","
+       << end.firstInMs << "," << end.firstOutMs << "\n";
+  }
+  if (m_silent > 0) {
+    NS_LOG_UNCOND("startup: " << m_silent << " of " << m_ends.size()
+                              << " TAPs never sent a frame");
+  }
+}
+
+}  // namespace ns3
@@ -0,0 +1,78 @@
+#ifndef ZENOH_SIM_TAP_READINESS_H
+#define ZENOH_SIM_TAP_READINESS_H
+
+#include "emulated-topology.h"
+
+#include "ns3/callback.h"
+#include "ns3/packet.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Startup barrier between the emulator and whatever waits for its links
+ * (launchers, publishers, benchmarks).
+ *
+ * The TAP bridges report every link end as it gets attached. Once the last
+ * one is up and the real-time loop runs, the ready file is written atomically
+ * (JSON: the attach and ready time of every TAP, on the wall clock and in ms
+ * since the emulator started). Waiting for that file to appear replaces fixed
+ * sleeps; script/tools/wait_ready.py does that. The file is removed again
+ * when the run ends, so it only exists while every TAP forwards.
+ *
+ * It also reports time-to-first-packet: the first frame each TAP sends into
+ * its link (MacTx) and the first one it gets back (MacPromiscRx). A log line
+ * marks the moment every TAP has sent something. startup.csv has the times of
+ * every TAP.
+ */
+class TapReadiness {
+ public:
+  TapReadiness(EmulatedTopology& topology, const std::string& outputDir);
+
+  /// Where to signal readiness (default <outputDir>/ready.json).
+  void SetReadyFile(const std::string& path);
+
+  /// Called at the ready point, whether or not every TAP got attached.
+  void SetReadyCallback(Callback<void> ready);
+
+  /// Link end `end` (2 * link + side) is attached to its TAP; called by the bridges.
+  void Attached(uint32_t end);
+
+  /// Hooks every link end; call once the bridges are installed.
+  void Start();
+  /// Writes startup.csv and removes the ready file.
+  void Finish();
+
+ private:
+  struct End {
+    TapReadiness* readiness;
+    uint32_t index;
+    double attachMs;  ///< -1 until attached
+    double firstInMs;
+    double firstOutMs;
+  };
+
+  static void OnTx(End* end, Ptr<const Packet> packet);
+  static void OnRx(End* end, Ptr<const Packet> packet);
+  void Publish();
+  double ElapsedMs() const;
+
+  EmulatedTopology& m_topology;
+  std::string m_outputDir;
+  std::string m_readyFile;
+  Callback<void> m_ready;
+  std::chrono::steady_clock::time_point m_origin;
+  double m_originWall;  ///< Unix time of m_origin
+  bool m_started;
+
+  std::vector<End> m_ends;
+  double m_readyMs;
+  uint32_t m_silent;  ///< ends that have not sent a frame yet
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_TAP_READINESS_H
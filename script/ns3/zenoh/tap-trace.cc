@@ -0,0 +1,356 @@
+#include "tap-trace.h"
+
+#include "ns3/abort.h"
+#include "ns3/callback.h"
+#include "ns3/csma-net-device.h"
+#include "ns3/log.h"
+#include "ns3/mac48-address.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("TapTrace");
+
+namespace {
+
+const uint32_t kVersion = 1;
+const uint32_t kRecordHeader = 16;
+const uint32_t kTrailer = 0xffffffff;
+const uint32_t kEthernetHeader = 14;
+const uint32_t kFcs = 4;
+
+/// Record header, followed by `length` frame bytes and padding to 8 bytes.
+struct Record {
+  int64_t timeNs;
+  uint32_t end;
+  uint32_t length;
+};
+static_assert(sizeof(Record) == kRecordHeader, "trace records are packed");
+
+uint64_t Align(uint64_t bytes) {
+  return (bytes + 7) & ~uint64_t(7);
+}
+
+void PutString(std::FILE* f, const std::string& s) {
+  uint16_t len = s.size();
+  std::fwrite(&len, sizeof(len), 1, f);
+  std::fwrite(s.data(), 1, len, f);
+}
+
+template <typename T>
+T Get(const uint8_t* data, uint64_t size, uint64_t& offset, const std::string& path) {
+  NS_ABORT_MSG_IF(offset + sizeof(T) > size, path << ": truncated header");
+  T v;
+  std::memcpy(&v, data + offset, sizeof(T));
+  offset += sizeof(T);
+  return v;
+}
+
+std::string GetString(const uint8_t* data, uint64_t size, uint64_t& offset,
+                      const std::string& path) {
+  uint16_t len = Get<uint16_t>(data, size, offset, path);
+  NS_ABORT_MSG_IF(offset + len > size, path << ": truncated header");
+  std::string s(reinterpret_cast<const char*>(data + offset), len);
+  offset += len;
+  return s;
+}
+
+}  // namespace
+
+TapTraceRecorder::TapTraceRecorder(EmulatedTopology& topology, const std::string& path)
+    : m_topology(topology),
+      m_path(path),
+      m_file(nullptr),
+      m_ring(64 << 20),
+      m_head(0),
+      m_tail(0),
+      m_frames(0),
+      m_dropped(0),
+      m_stopWriter(false) {}
+
+TapTraceRecorder::~TapTraceRecorder() {
+  Stop();
+}
+
+void TapTraceRecorder::SetRingBytes(uint64_t bytes) {
+  m_ring.assign(Align(bytes), 0);
+}
+
+void TapTraceRecorder::Start() {
+  uint32_t n = 2 * m_topology.GetLinks().size();
+  m_ends.assign(n, End());
+  m_frame.assign(65536 + 8, 0);
+  uint32_t i = 0;
+  for (auto& link : m_topology.GetLinks()) {
+    for (auto& end : link.ends) {
+      m_ends[i] = End{this, i};
+      end.device->TraceConnectWithoutContext(
+          "MacTx", MakeBoundCallback(&TapTraceRecorder::OnTx, &m_ends[i]));
+      ++i;
+    }
+  }
+
+  m_file = std::fopen(m_path.c_str(), "wb");
+  NS_ABORT_MSG_IF(!m_file, "cannot open " << m_path);
+  WriteHeader();
+  m_writer = std::thread(&TapTraceRecorder::WriterLoop, this);
+}
+
+void TapTraceRecorder::WriteHeader() {
+  // The size of the end table is only known once it is written.
+  std::fwrite("ZTRC", 1, 4, m_file);
+  uint32_t fields[3] = {kVersion, static_cast<uint32_t>(m_ends.size()), 0};
+  std::fwrite(fields, sizeof(fields), 1, m_file);
+  for (const auto& link : m_topology.GetLinks()) {
+    for (uint8_t side = 0; side < 2; ++side) {
+      uint32_t index = link.index;
+      uint8_t fcs = DynamicCast<CsmaNetDevice>(link.ends[side].device) ? kFcs : 0;
+      std::fwrite(&index, sizeof(index), 1, m_file);
+      std::fwrite(&side, sizeof(side), 1, m_file);
+      std::fwrite(&fcs, sizeof(fcs), 1, m_file);
+      PutString(m_file, link.ends[side].tapName);
+      PutString(m_file, link.ends[side].nodeId);
+    }
+  }
+  long pos = std::ftell(m_file);
+  uint64_t zero = 0;
+  std::fwrite(&zero, 1, Align(pos) - pos, m_file);
+  fields[2] = Align(pos);
+  std::fseek(m_file, 12, SEEK_SET);
+  std::fwrite(&fields[2], sizeof(fields[2]), 1, m_file);
+  std::fseek(m_file, 0, SEEK_END);
+}
+
+void TapTraceRecorder::Put(uint64_t pos, const void* data, uint64_t bytes) {
+  uint64_t slot = pos % m_ring.size();
+  uint64_t first = std::min<uint64_t>(bytes, m_ring.size() - slot);
+  std::memcpy(&m_ring[slot], data, first);
+  std::memcpy(&m_ring[0], static_cast<const uint8_t*>(data) + first, bytes - first);
+}
+
+void TapTraceRecorder::OnTx(End* end, Ptr<const Packet> packet) {
+  TapTraceRecorder* self = end->recorder;
+  uint32_t size = std::min<uint32_t>(packet->GetSize(), self->m_frame.size() - 8);
+  uint64_t bytes = Align(kRecordHeader + size);
+  uint64_t head = self->m_head.load(std::memory_order_relaxed);
+  if (head + bytes - self->m_tail.load(std::memory_order_acquire) > self->m_ring.size()) {
+    ++self->m_dropped;
+    return;
+  }
+  Record record{Simulator::Now().GetNanoSeconds(), end->index, size};
+  packet->CopyData(self->m_frame.data(), size);
+  std::memset(self->m_frame.data() + size, 0, bytes - kRecordHeader - size);
+  self->Put(head, &record, kRecordHeader);
+  self->Put(head + kRecordHeader, self->m_frame.data(), bytes - kRecordHeader);
+  self->m_head.store(head + bytes, std::memory_order_release);
+  ++self->m_frames;
+}
+
+void TapTraceRecorder::Drain() {
+  uint64_t tail = m_tail.load(std::memory_order_relaxed);
+  uint64_t head = m_head.load(std::memory_order_acquire);
+  while (tail < head) {
+    uint64_t slot = tail % m_ring.size();
+    uint64_t count = std::min<uint64_t>(head - tail, m_ring.size() - slot);
+    std::fwrite(&m_ring[slot], 1, count, m_file);
+    tail += count;
+    m_tail.store(tail, std::memory_order_release);
+  }
+  std::fflush(m_file);
+}
+
+void TapTraceRecorder::WriterLoop() {
+  while (!m_stopWriter.load(std::memory_order_acquire)) {
+    Drain();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  Drain();
+}
+
+void TapTraceRecorder::Stop() {
+  if (!m_file) {
+    return;
+  }
+  m_stopWriter.store(true, std::memory_order_release);
+  if (m_writer.joinable()) {
+    m_writer.join();
+  }
+  Record trailer{Simulator::Now().GetNanoSeconds(), kTrailer, 16};
+  uint64_t counts[2] = {m_frames, m_dropped};
+  std::fwrite(&trailer, sizeof(trailer), 1, m_file);
+  std::fwrite(counts, sizeof(counts), 1, m_file);
+  std::fclose(m_file);
+  m_file = nullptr;
+  NS_LOG_UNCOND("tap trace: " << m_frames << " frames (" << m_dropped << " dropped) in "
+                              << m_path);
+}
+
+TapTraceReplay::TapTraceReplay(EmulatedTopology& topology)
+    : m_topology(topology), m_active(0), m_unsent(0) {}
+
+TapTraceReplay::~TapTraceReplay() {
+  for (Source& source : m_sources) {
+    if (source.data) {
+      munmap(const_cast<uint8_t*>(source.data), source.size);
+    }
+  }
+}
+
+void TapTraceReplay::Open(Source& source) {
+  const std::string& path = source.path;
+  int fd = open(path.c_str(), O_RDONLY);
+  NS_ABORT_MSG_IF(fd < 0, "cannot open " << path);
+  struct stat st;
+  NS_ABORT_MSG_IF(fstat(fd, &st) != 0 || st.st_size < 16, path << ": not a TAP trace");
+  void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  NS_ABORT_MSG_IF(map == MAP_FAILED, "cannot map " << path);
+  madvise(map, st.st_size, MADV_SEQUENTIAL);
+  source.data = static_cast<const uint8_t*>(map);
+  source.size = st.st_size;
+
+  uint64_t offset = 4;
+  uint32_t version = Get<uint32_t>(source.data, source.size, offset, path);
+  NS_ABORT_MSG_IF(std::memcmp(source.data, "ZTRC", 4) != 0 || version != kVersion,
+                  path << ": not a version " << kVersion << " TAP trace");
+  uint32_t ends = Get<uint32_t>(source.data, source.size, offset, path);
+  source.offset = Get<uint32_t>(source.data, source.size, offset, path);
+
+  std::vector<EmulatedLink>& links = m_topology.GetLinks();
+  for (uint32_t i = 0; i < ends; ++i) {
+    uint32_t index = Get<uint32_t>(source.data, source.size, offset, path);
+    uint8_t side = Get<uint8_t>(source.data, source.size, offset, path);
+    uint8_t fcs = Get<uint8_t>(source.data, source.size, offset, path);
+    std::string tap = GetString(source.data, source.size, offset, path);
+    GetString(source.data, source.size, offset, path);
+    auto link = std::find_if(links.begin(), links.end(),
+                             [index](const EmulatedLink& l) { return l.index == index; });
+    NS_ABORT_MSG_IF(link == links.end() || side > 1 || link->ends[side].tapName != tap,
+                    path << ": " << tap << " is not in this topology (another config?)");
+    source.devices.push_back(link->ends[side].device);
+    source.fcsBytes.push_back(fcs);
+  }
+  NS_ABORT_MSG_IF(source.offset < offset || source.offset > source.size,
+                  path << ": bad record offset");
+}
+
+bool TapTraceReplay::Next(Source& source, int64_t& timeNs) {
+  if (source.offset + kRecordHeader > source.size) {
+    return false;
+  }
+  Record record;
+  std::memcpy(&record, source.data + source.offset, sizeof(record));
+  if (record.end == kTrailer) {
+    if (source.offset + kRecordHeader + 16 <= source.size) {
+      std::memcpy(&source.recordedDrops, source.data + source.offset + kRecordHeader + 8, 8);
+      source.complete = true;
+    }
+    return false;
+  }
+  if (record.end >= source.devices.size() ||
+      source.offset + kRecordHeader + record.length > source.size) {
+    return false;  // cut short
+  }
+  timeNs = record.timeNs;
+  return true;
+}
+
+void TapTraceReplay::Send(Source* source) {
+  TapTraceReplay* self = source->replay;
+  int64_t now = Simulator::Now().GetNanoSeconds();
+  int64_t timeNs = 0;
+  while (self->Next(*source, timeNs) && timeNs <= now) {
+    Record record;
+    std::memcpy(&record, source->data + source->offset, sizeof(record));
+    const uint8_t* frame = source->data + source->offset + kRecordHeader;
+    source->offset += Align(kRecordHeader + record.length);
+    ++source->frames;
+
+    uint32_t trim = kEthernetHeader + source->fcsBytes[record.end];
+    if (record.length < trim) {
+      continue;
+    }
+    // SendFrom adds the Ethernet header (and the FCS on CSMA) again.
+    Ptr<Packet> packet = Create<Packet>(frame + kEthernetHeader, record.length - trim);
+    Mac48Address dst;
+    Mac48Address src;
+    dst.CopyFrom(frame);
+    src.CopyFrom(frame + 6);
+    uint16_t type = frame[12] << 8 | frame[13];
+    if (!source->devices[record.end]->SendFrom(packet, src, dst, type)) {
+      ++self->m_unsent;
+    }
+  }
+  if (self->Next(*source, timeNs)) {
+    Simulator::Schedule(NanoSeconds(timeNs - now), &TapTraceReplay::Send, source);
+  } else if (--self->m_active == 0) {
+    Simulator::Stop(Seconds(1));
+  }
+}
+
+void TapTraceReplay::Discard(Ptr<NetDevice> device,
+                             Ptr<const Packet> packet,
+                             uint16_t protocol,
+                             const Address& from,
+                             const Address& to,
+                             NetDevice::PacketType type) {}
+
+void TapTraceReplay::Start(const std::vector<std::string>& paths) {
+  NS_ABORT_MSG_IF(paths.empty(), "replay needs at least one TAP trace");
+  // Devices only fire MacPromiscRx, which the latency probe, telemetry and
+  // recorder hook, with a promiscuous handler installed.
+  for (auto& link : m_topology.GetLinks()) {
+    for (auto& end : link.ends) {
+      end.node->RegisterProtocolHandler(MakeCallback(&TapTraceReplay::Discard), 0, end.device,
+                                        true);
+    }
+  }
+  m_sources.assign(paths.size(), Source());
+  for (uint32_t i = 0; i < paths.size(); ++i) {
+    Source& source = m_sources[i];
+    source.replay = this;
+    source.path = paths[i];
+    source.data = nullptr;
+    source.frames = 0;
+    source.recordedDrops = 0;
+    source.complete = false;
+    Open(source);
+
+    int64_t timeNs = 0;
+    if (Next(source, timeNs)) {
+      ++m_active;
+      Simulator::Schedule(NanoSeconds(timeNs), &TapTraceReplay::Send, &source);
+    }
+  }
+  if (m_active == 0) {
+    Simulator::Stop(Seconds(1));
+  }
+  NS_LOG_UNCOND("replaying " << paths.size() << " TAP trace(s), as fast as possible");
+}
+
+void TapTraceReplay::Finish() {
+  uint64_t frames = 0;
+  for (Source& source : m_sources) {
+    frames += source.frames;
+    if (!source.complete) {
+      NS_LOG_UNCOND("replay: " << source.path << " has no trailer, the recording was cut short");
+    } else if (source.recordedDrops > 0) {
+      NS_LOG_UNCOND("replay: " << source.path << " misses " << source.recordedDrops
+                               << " frames the recorder dropped");
+    }
+  }
+  NS_LOG_UNCOND("replay: " << frames << " frames sent, " << m_unsent
+                           << " refused by their device (link down or queue full)");
+}
+
+}  // namespace ns3
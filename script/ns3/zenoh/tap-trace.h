@@ -0,0 +1,134 @@
+#ifndef ZENOH_SIM_TAP_TRACE_H
+#define ZENOH_SIM_TAP_TRACE_H
+
+#include "emulated-topology.h"
+
+#include "ns3/net-device.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Records every frame the TAPs send into their links (the devices' MacTx),
+ * with its simulation time, so that TapTraceReplay can feed the same input
+ * to the topology again without TAPs or containers.
+ *
+ * Like LinkTelemetry, the trace callback only copies the frame into a
+ * preallocated byte ring, and a background thread streams the ring to disk.
+ * If the writer falls a whole ring behind, frames are dropped and counted
+ * rather than blocking the real-time loop.
+ *
+ * File layout (little endian, every record 8-byte aligned so the file can be
+ * walked in place once mapped), read by script/tools/tap_trace.py:
+ *   header  "ZTRC" u32 version, u32 ends, u32 offset of the first record
+ *   per end: u32 link index, u8 side, u8 FCS bytes after the payload, then
+ *            TAP name and node id as u16 length + bytes; zero padding
+ *   records i64 simulation ns, u32 end, u32 frame length, the frame
+ *           (Ethernet header onwards), zero padding
+ *   trailer a record with end 0xffffffff and 16 bytes: u64 frames written,
+ *           u64 frames dropped
+ * A file cut short by a crash holds every record up to the last full one.
+ */
+class TapTraceRecorder {
+ public:
+  TapTraceRecorder(EmulatedTopology& topology, const std::string& path);
+  ~TapTraceRecorder();
+
+  /// Capacity of the ring in bytes (default 64 MiB).
+  void SetRingBytes(uint64_t bytes);
+
+  /// Hooks every link end and starts the writer thread.
+  void Start();
+  /// Flushes everything and closes the file; call after Simulator::Run.
+  void Stop();
+
+ private:
+  struct End {
+    TapTraceRecorder* recorder;
+    uint32_t index;
+  };
+
+  static void OnTx(End* end, Ptr<const Packet> packet);
+  void WriteHeader();
+  void Put(uint64_t pos, const void* data, uint64_t bytes);
+  void WriterLoop();
+  void Drain();
+
+  EmulatedTopology& m_topology;
+  std::string m_path;
+  std::FILE* m_file;
+
+  std::vector<End> m_ends;
+  std::vector<uint8_t> m_frame;
+  std::vector<uint8_t> m_ring;
+  std::atomic<uint64_t> m_head;  ///< next byte the simulator writes
+  std::atomic<uint64_t> m_tail;  ///< next byte the writer flushes
+  uint64_t m_frames;
+  uint64_t m_dropped;
+  std::atomic<bool> m_stopWriter;
+  std::thread m_writer;
+};
+
+/**
+ * Sends the frames of one or more TapTraceRecorder files into the link ends
+ * they were recorded on, at their recorded times. The topology must come
+ * from the same config; the link type may differ (--linkType), the FCS that
+ * CSMA links add is stripped before a frame is sent again.
+ *
+ * Traces are mapped read-only and walked in place: each file has a single
+ * pending event for its next frames, so memory does not grow with the trace.
+ * Like the TAP bridges, the replay takes every frame the devices receive,
+ * and discards it, so the receive traces fire as they do live.
+ * The run stops one second after the last frame, when the links are
+ * drained.
+ */
+class TapTraceReplay {
+ public:
+  explicit TapTraceReplay(EmulatedTopology& topology);
+  ~TapTraceReplay();
+
+  /// Maps the traces and schedules their first frames.
+  void Start(const std::vector<std::string>& paths);
+  void Finish();
+
+ private:
+  struct Source {
+    TapTraceReplay* replay;
+    std::string path;
+    const uint8_t* data;
+    uint64_t size;
+    uint64_t offset;  ///< next record
+    std::vector<Ptr<NetDevice>> devices;  ///< [trace end]
+    std::vector<uint8_t> fcsBytes;        ///< [trace end]
+    uint64_t frames;
+    uint64_t recordedDrops;  ///< from the trailer
+    bool complete;           ///< the trailer was found
+  };
+
+  static void Send(Source* source);
+  static void Discard(Ptr<NetDevice> device,
+                      Ptr<const Packet> packet,
+                      uint16_t protocol,
+                      const Address& from,
+                      const Address& to,
+                      NetDevice::PacketType type);
+  void Open(Source& source);
+  bool Next(Source& source, int64_t& timeNs);
+
+  EmulatedTopology& m_topology;
+  std::vector<Source> m_sources;
+  uint32_t m_active;  ///< sources with frames left
+  uint64_t m_unsent;  ///< frames the device refused (link down, queue full)
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_TAP_TRACE_H
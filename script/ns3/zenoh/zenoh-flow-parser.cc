@@ -0,0 +1,847 @@
+#include "zenoh-flow-parser.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ns3 {
+
+namespace {
+
+// Zenoh 1.x wire ids (zenoh-protocol transport::id and network::id).
+const uint8_t kTransportOam = 0x00;
+const uint8_t kKeepAlive = 0x04;
+const uint8_t kFrame = 0x05;
+const uint8_t kFragment = 0x06;
+const uint8_t kJoin = 0x07;
+const uint8_t kInterest = 0x19;
+const uint8_t kResponseFinal = 0x1a;
+const uint8_t kNetworkOam = 0x1f;
+const uint8_t kDeclare = 0x1e;
+const uint8_t kPush = 0x1d;
+
+// Declarations inside DECLARE.
+const uint8_t kDeclKeyExpr = 0x00;
+const uint8_t kUndeclKeyExpr = 0x01;
+const uint8_t kUndeclToken = 0x07;
+const uint8_t kDeclFinal = 0x1a;
+
+// Push bodies.
+const uint8_t kPut = 0x01;
+const uint8_t kDel = 0x02;
+
+// Header flags. Bit 7 always announces extensions; 5 and 6 depend on the id.
+const uint8_t kFlagZ = 0x80;
+const uint8_t kFlag5 = 0x20;  ///< N (suffix), T (timestamp), I (interest id)
+const uint8_t kFlag6 = 0x40;  ///< M (sender mapping), E (encoding), More (fragment)
+
+// QoS extension of FRAME and FRAGMENT; its z64 holds the priority in bits 0-2.
+const uint8_t kExtQos = 0x01;
+const uint8_t kDefaultPriority = 5;  ///< Data
+
+const uint8_t kTcpFin = 0x01;
+const uint8_t kTcpSyn = 0x02;
+const uint8_t kTcpRst = 0x04;
+
+/// Batches given up in a row before the framing itself is distrusted.
+const uint32_t kMaxFailures = 4;
+
+uint16_t Be16(const uint8_t* p) {
+  return static_cast<uint16_t>(p[0] << 8 | p[1]);
+}
+
+uint32_t Be32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+         static_cast<uint32_t>(p[2]) << 8 | p[3];
+}
+
+bool PlausibleBatchStart(const uint8_t* p) {
+  uint8_t id = p[0] & 0x1f;
+  return id == kFrame || id == kFragment || id == kKeepAlive;
+}
+
+/// Bounds-checked cursor over one contiguous view; sticky on the first problem.
+struct Reader {
+  enum State { GOOD, SHORT, BAD };
+
+  Reader(const uint8_t* begin, uint32_t len) : start(begin), p(begin), end(begin + len), state(GOOD) {}
+
+  uint8_t U8() {
+    if (state != GOOD || p == end) {
+      state = state == GOOD ? SHORT : state;
+      return 0;
+    }
+    return *p++;
+  }
+
+  /// Zenoh's variable length integer: 7 bits per byte, the 9th byte is full.
+  uint64_t Z64() {
+    uint64_t v = 0;
+    for (uint32_t i = 0; i < 9; ++i) {
+      uint8_t b = U8();
+      if (state != GOOD) {
+        return 0;
+      }
+      if (i == 8) {
+        return v | static_cast<uint64_t>(b) << 56;
+      }
+      v |= static_cast<uint64_t>(b & 0x7f) << (7 * i);
+      if (!(b & 0x80)) {
+        return v;
+      }
+    }
+    return v;
+  }
+
+  const uint8_t* Bytes(uint64_t n) {
+    if (state != GOOD) {
+      return nullptr;
+    }
+    if (static_cast<uint64_t>(end - p) < n) {
+      state = SHORT;
+      return nullptr;
+    }
+    const uint8_t* at = p;
+    p += n;
+    return at;
+  }
+
+  /// Skips the extension chain; stores the z64 of extension `id` in `value`, if given.
+  void Extensions(uint8_t id = 0, uint64_t* value = nullptr) {
+    for (;;) {
+      uint8_t h = U8();
+      switch ((h >> 5) & 0x3) {
+        case 0:  // unit
+          break;
+        case 1: {  // z64
+          uint64_t v = Z64();
+          if (value && (h & 0x0f) == id) {
+            *value = v;
+          }
+          break;
+        }
+        case 2:  // zbuf
+          Bytes(Z64());
+          break;
+        default:
+          Fail();
+      }
+      if (state != GOOD || !(h & kFlagZ)) {
+        return;
+      }
+    }
+  }
+
+  /// Wire expression: numeric scope plus, when `named`, a string suffix.
+  void WireExpr(bool named, uint16_t& scope, const uint8_t*& suffix, uint32_t& suffixLen) {
+    uint64_t s = Z64();
+    if (s > 0xffff) {
+      Fail();
+    }
+    scope = static_cast<uint16_t>(s);
+    suffix = nullptr;
+    suffixLen = 0;
+    if (named) {
+      uint64_t n = Z64();
+      suffix = Bytes(n);
+      suffixLen = static_cast<uint32_t>(n);
+    }
+  }
+
+  void Fail() {
+    if (state == GOOD) {
+      state = BAD;
+    }
+  }
+
+  uint32_t Consumed() const { return static_cast<uint32_t>(p - start); }
+
+  const uint8_t* start;
+  const uint8_t* p;
+  const uint8_t* end;
+  State state;
+};
+
+}  // namespace
+
+ZenohFlowParser::ZenohFlowParser(uint32_t directions, uint32_t maxStreams, uint32_t maxKeys)
+    : m_directions(directions),
+      m_maxKeys(std::max<uint32_t>(maxKeys, 2)),
+      m_nKeys(0),
+      m_fpBytes(0),
+      m_framePriority(kNoPriority) {
+  uint32_t slots = 1;
+  while (slots < maxStreams) {
+    slots <<= 1;
+  }
+  m_streams.resize(slots);
+  for (auto& s : m_streams) {
+    s.used = false;
+  }
+  slots = 1;
+  while (slots < 2 * m_maxKeys) {
+    slots <<= 1;
+  }
+  m_keySlots.assign(slots, 0);
+  m_keyChars.assign(static_cast<size_t>(m_maxKeys) * kMaxKeyLength, 0);
+  m_keyLengths.assign(m_maxKeys, 0);
+  m_bytes.assign(static_cast<size_t>(m_maxKeys) * m_directions, 0);
+
+  Intern("(control)", 9);
+  Intern("(unknown)", 9);
+}
+
+std::string ZenohFlowParser::GetKey(uint16_t key) const {
+  return std::string(&m_keyChars[static_cast<size_t>(key) * kMaxKeyLength], m_keyLengths[key]);
+}
+
+uint16_t ZenohFlowParser::Intern(const char* key, uint32_t len) {
+  if (len == 0 || len >= kMaxKeyLength) {
+    return kUnknownKey;
+  }
+  uint32_t h = 2166136261u;  // FNV-1a
+  for (uint32_t i = 0; i < len; ++i) {
+    h = (h ^ static_cast<uint8_t>(key[i])) * 16777619u;
+  }
+  uint32_t mask = m_keySlots.size() - 1;
+  for (uint32_t i = h & mask;; i = (i + 1) & mask) {
+    uint32_t slot = m_keySlots[i];
+    if (slot == 0) {
+      if (m_nKeys == m_maxKeys) {
+        ++m_stats.keyTableFull;
+        return kUnknownKey;
+      }
+      uint16_t id = m_nKeys++;
+      std::memcpy(&m_keyChars[static_cast<size_t>(id) * kMaxKeyLength], key, len);
+      m_keyLengths[id] = len;
+      m_keySlots[i] = id + 1;
+      return id;
+    }
+    uint16_t id = slot - 1;
+    if (m_keyLengths[id] == len &&
+        std::memcmp(&m_keyChars[static_cast<size_t>(id) * kMaxKeyLength], key, len) == 0) {
+      return id;
+    }
+  }
+}
+
+uint32_t ZenohFlowParser::HomeSlot(uint32_t srcIp,
+                                   uint32_t dstIp,
+                                   uint16_t srcPort,
+                                   uint16_t dstPort) const {
+  uint32_t h = (srcIp * 2654435761u) ^ (dstIp * 40503u) ^ (static_cast<uint32_t>(srcPort) << 16 | dstPort);
+  h ^= h >> 15;
+  return h & (m_streams.size() - 1);
+}
+
+ZenohFlowParser::Stream* ZenohFlowParser::FindStream(uint32_t srcIp,
+                                                     uint32_t dstIp,
+                                                     uint16_t srcPort,
+                                                     uint16_t dstPort,
+                                                     bool create) {
+  uint32_t mask = m_streams.size() - 1;
+  uint32_t home = HomeSlot(srcIp, dstIp, srcPort, dstPort);
+  for (uint32_t n = 0, i = home; n < m_streams.size(); ++n, i = (i + 1) & mask) {
+    Stream& s = m_streams[i];
+    if (!s.used) {
+      if (!create) {
+        return nullptr;
+      }
+      s.used = true;
+      s.srcIp = srcIp;
+      s.dstIp = dstIp;
+      s.srcPort = srcPort;
+      s.dstPort = dstPort;
+      s.lastSeen = m_stats.frames;
+      ResetStream(s, 0);
+      s.synced = false;
+      ++m_stats.streams;
+      return &s;
+    }
+    if (s.srcIp == srcIp && s.dstIp == dstIp && s.srcPort == srcPort && s.dstPort == dstPort) {
+      return &s;
+    }
+  }
+  if (!create) {
+    return nullptr;
+  }
+  // Full: drop the stream that has been quiet longest, most likely one
+  // whose session went away without a FIN, and probe again.
+  Stream* oldest = &m_streams[0];
+  for (Stream& s : m_streams) {
+    oldest = s.lastSeen < oldest->lastSeen ? &s : oldest;
+  }
+  ReleaseStream(*oldest);
+  ++m_stats.streamTableFull;
+  return FindStream(srcIp, dstIp, srcPort, dstPort, true);
+}
+
+void ZenohFlowParser::ReleaseStream(Stream& s) {
+  // Linear probing without tombstones: move later entries of the probe run
+  // back into the hole unless that would put them before their home slot.
+  uint32_t mask = m_streams.size() - 1;
+  uint32_t hole = &s - m_streams.data();
+  m_streams[hole].used = false;
+  for (uint32_t i = (hole + 1) & mask; m_streams[i].used; i = (i + 1) & mask) {
+    Stream& next = m_streams[i];
+    uint32_t home = HomeSlot(next.srcIp, next.dstIp, next.srcPort, next.dstPort);
+    if (((i - home) & mask) >= ((i - hole) & mask)) {
+      m_streams[hole] = next;
+      next.used = false;
+      hole = i;
+    }
+  }
+}
+
+void ZenohFlowParser::SetPayloadCallback(uint32_t bytes, PayloadCallback cb) {
+  m_fpBytes = bytes;
+  m_payloadCallback = cb;
+}
+
+void ZenohFlowParser::ResetStream(Stream& s, uint32_t nextSeq) {
+  s.synced = true;
+  s.nextSeq = nextSeq;
+  s.batchLeft = 0;
+  s.inFrame = false;
+  s.skip = 0;
+  s.skipKey = kControlKey;
+  s.fragActive = false;
+  s.fragKey = kControlKey;
+  s.failures = 0;
+  s.priority = kNoPriority;
+  s.fpDelay = 0;
+  s.fpLeft = 0;
+  s.nMappings = 0;
+  s.pendingLen = 0;
+}
+
+bool ZenohFlowParser::OnFrame(uint32_t dir, const uint8_t* frame, uint32_t captured, uint32_t size) {
+  m_framePriority = kNoPriority;
+  captured = std::min(captured, size);
+  uint32_t off = 14;
+  if (captured < off + 20) {
+    return true;
+  }
+  uint16_t etherType = Be16(frame + 12);
+  if (etherType == 0x8100) {
+    off += 4;
+    etherType = captured >= off + 20 ? Be16(frame + 16) : 0;
+  }
+  if (etherType != 0x0800) {
+    return true;
+  }
+  const uint8_t* ip = frame + off;
+  uint32_t ihl = (ip[0] & 0x0f) * 4;
+  if ((ip[0] >> 4) != 4 || ihl < 20 || ip[9] != 6 || (Be16(ip + 6) & 0x3fff) != 0) {
+    return true;
+  }
+  if (captured < off + ihl + 20) {
+    return size < off + ihl + 20;
+  }
+  ++m_stats.frames;
+  const uint8_t* tcp = ip + ihl;
+  uint32_t thl = (tcp[12] >> 4) * 4;
+  uint8_t flags = tcp[13];
+  uint32_t seq = Be32(tcp + 4);
+  uint32_t payloadOff = off + ihl + thl;
+  uint32_t ipLen = Be16(ip + 2);
+  if (thl < 20 || ipLen < ihl + thl || payloadOff > size) {
+    return true;
+  }
+  // The IP length excludes Ethernet padding of short frames.
+  uint32_t payloadLen = std::min(ipLen - ihl - thl, size - payloadOff);
+
+  // Pure ACKs and the FIN of a released stream do not take a slot.
+  bool create = payloadLen > 0 || (flags & kTcpSyn);
+  Stream* s = FindStream(Be32(ip + 12), Be32(ip + 16), Be16(tcp), Be16(tcp + 2), create);
+  if (!s) {
+    return true;
+  }
+  s->dir = dir;
+  s->lastSeen = m_stats.frames;
+  if (flags & kTcpSyn) {
+    ResetStream(*s, seq + 1);
+    return true;
+  }
+  if (flags & (kTcpRst | kTcpFin)) {
+    ReleaseStream(*s);
+    return true;
+  }
+  if (payloadLen == 0) {
+    return true;
+  }
+
+  int32_t gap = static_cast<int32_t>(seq - s->nextSeq);
+  // Bulk of a large payload: account it without looking at the bytes.
+  if (s->synced && gap == 0 && s->skip >= payloadLen && s->fpLeft == 0) {
+    Account(dir, s->skipKey, payloadLen);
+    NotePriority(*s);
+    s->skip -= payloadLen;
+    s->batchLeft -= payloadLen;
+    s->nextSeq += payloadLen;
+    return true;
+  }
+  if (captured < payloadOff + payloadLen) {
+    return false;
+  }
+  const uint8_t* payload = frame + payloadOff;
+
+  if (!s->synced || gap > 0) {
+    // Joined mid-stream or a hole in the sequence space: framing is lost.
+    s->synced = false;
+    s->nextSeq = seq + payloadLen;
+    if (Resync(*s, payload, payloadLen)) {
+      Feed(*s, payload, payloadLen);
+    }
+    return true;
+  }
+  if (gap < 0) {
+    // Retransmission, possibly carrying some new data at its end.
+    if (static_cast<int64_t>(gap) + payloadLen <= 0) {
+      return true;
+    }
+    payload += -gap;
+    payloadLen -= -gap;
+  }
+  s->nextSeq += payloadLen;
+  Feed(*s, payload, payloadLen);
+  return true;
+}
+
+bool ZenohFlowParser::Resync(Stream& s, const uint8_t* data, uint32_t len) {
+  // Accept a segment that starts with a batch whose header looks like a
+  // FRAME/FRAGMENT/KEEP_ALIVE and, when visible, is followed by another one.
+  if (len < 3) {
+    return false;
+  }
+  uint32_t batch = data[0] | data[1] << 8;
+  if (batch == 0 || !PlausibleBatchStart(data + 2)) {
+    return false;
+  }
+  uint32_t next = 2 + batch;
+  if (next + 2 < len &&
+      ((data[next] | data[next + 1] << 8) == 0 || !PlausibleBatchStart(data + next + 2))) {
+    return false;
+  }
+  uint16_t nMappings = s.nMappings;
+  ResetStream(s, s.nextSeq);
+  // Declarations seen before the hole most likely still hold.
+  s.nMappings = nMappings;
+  ++m_stats.resyncs;
+  return true;
+}
+
+void ZenohFlowParser::GiveUpBatch(Stream& s) {
+  // The carried bytes belong to the failed unit and have not been accounted.
+  Account(s.dir, kControlKey, s.pendingLen);
+  s.batchLeft -= s.pendingLen;
+  m_stats.unparsedBytes += s.batchLeft + s.pendingLen;
+  s.pendingLen = 0;
+  s.skip = s.batchLeft;
+  s.skipKey = kControlKey;
+  s.inFrame = false;
+  s.fragActive = false;
+  s.fpLeft = 0;
+  if (++s.failures >= kMaxFailures) {
+    s.synced = false;
+  }
+}
+
+void ZenohFlowParser::Feed(Stream& s, const uint8_t* data, uint32_t len) {
+  while (len > 0 && s.synced) {
+    if (s.skip > 0) {
+      uint32_t n = std::min(s.skip, len);
+      if (s.fpLeft > 0) {
+        Fingerprint(s, data, n);
+      }
+      Account(s.dir, s.skipKey, n);
+      NotePriority(s);
+      s.skip -= n;
+      s.batchLeft -= n;
+      data += n;
+      len -= n;
+      continue;
+    }
+
+    // A unit is decoded from one contiguous view: the segment itself, or the
+    // carry buffer when the unit started in an earlier segment. s.batchLeft
+    // counts from the start of that view.
+    uint32_t carried = s.pendingLen;
+    const uint8_t* view = data;
+    uint32_t viewLen = len;
+    if (carried > 0) {
+      uint32_t n = std::min(len, kPending - carried);
+      std::memcpy(s.pending + carried, data, n);
+      s.pendingLen += n;
+      view = s.pending;
+      viewLen = s.pendingLen;
+    }
+    bool batchEndInView = s.batchLeft > 0 && viewLen >= s.batchLeft;
+    if (s.batchLeft > 0) {
+      viewLen = std::min(viewLen, s.batchLeft);
+    }
+
+    Unit unit = {0, kControlKey, 0, kControlKey, 0, 0};
+    Result result;
+    uint32_t newBatch = 0;
+    if (s.batchLeft == 0) {
+      result = viewLen < 2 ? NEED_MORE : OK;
+      if (result == OK) {
+        unit.length = 2;
+        newBatch = view[0] | view[1] << 8;
+      }
+    } else {
+      result = ParseUnit(s, view, viewLen, unit);
+      if (result == NEED_MORE && batchEndInView) {
+        result = FAIL;
+      }
+      if (result == OK && (unit.length <= carried || unit.length + unit.skip > s.batchLeft)) {
+        result = FAIL;
+      }
+    }
+
+    if (result == NEED_MORE) {
+      if (carried > 0) {
+        if (s.pendingLen < kPending) {
+          return;  // all of `data` is in the carry buffer now
+        }
+        result = FAIL;
+      } else if (len <= kPending) {
+        std::memcpy(s.pending, data, len);
+        s.pendingLen = len;
+        return;
+      } else {
+        result = FAIL;
+      }
+    }
+    if (result == FAIL) {
+      s.pendingLen = carried;
+      GiveUpBatch(s);
+      continue;
+    }
+
+    uint32_t fromData = unit.length - carried;
+    s.pendingLen = 0;
+    s.failures = 0;
+    Account(s.dir, unit.key, unit.length);
+    if (s.batchLeft == 0) {
+      s.batchLeft = newBatch;
+      s.inFrame = false;
+      s.priority = kNoPriority;
+    } else {
+      s.batchLeft -= unit.length;
+      NotePriority(s);
+    }
+    s.skip = unit.skip;
+    s.skipKey = unit.skipKey;
+    if (m_payloadCallback && unit.payload > 0 && unit.skip > unit.payloadOffset) {
+      uint32_t bytes = m_fpBytes > 0 ? std::min(m_fpBytes, unit.payload) : unit.payload;
+      s.fpDelay = unit.payloadOffset;
+      s.fpLeft = std::min(bytes, unit.skip - unit.payloadOffset);
+      s.fpKey = unit.key;
+      // FNV-1a, seeded with the payload length.
+      s.fpHash = 14695981039346656037ull ^ unit.payload;
+    }
+    data += fromData;
+    len -= fromData;
+  }
+}
+
+void ZenohFlowParser::Fingerprint(Stream& s, const uint8_t* data, uint32_t len) {
+  uint32_t delay = std::min(s.fpDelay, len);
+  s.fpDelay -= delay;
+  uint32_t n = std::min(s.fpLeft, len - delay);
+  for (uint32_t i = delay; i < delay + n; ++i) {
+    s.fpHash = (s.fpHash ^ data[i]) * 1099511628211ull;
+  }
+  s.fpLeft -= n;
+  if (s.fpLeft == 0) {
+    m_payloadCallback(s.dir, s.fpKey, s.fpHash);
+  }
+}
+
+ZenohFlowParser::Result ZenohFlowParser::ParseUnit(Stream& s,
+                                                   const uint8_t* p,
+                                                   uint32_t len,
+                                                   Unit& unit) {
+  uint8_t id = p[0] & 0x1f;
+  if (id >= kInterest) {
+    return s.inFrame ? ParseNetwork(s, p, len, unit) : FAIL;
+  }
+
+  Reader r(p, len);
+  uint8_t h = r.U8();
+  switch (id) {
+    case kFrame: {
+      uint64_t qos = kDefaultPriority;
+      r.Z64();  // sequence number
+      if (h & kFlagZ) {
+        r.Extensions(kExtQos, &qos);
+      }
+      if (r.state != Reader::GOOD) {
+        return r.state == Reader::SHORT ? NEED_MORE : FAIL;
+      }
+      s.inFrame = true;
+      s.priority = qos & 0x7;
+      unit.length = r.Consumed();
+      return OK;
+    }
+
+    case kFragment: {
+      uint64_t qos = kDefaultPriority;
+      r.Z64();
+      if (h & kFlagZ) {
+        r.Extensions(kExtQos, &qos);
+      }
+      if (r.state != Reader::GOOD) {
+        return r.state == Reader::SHORT ? NEED_MORE : FAIL;
+      }
+      uint32_t header = r.Consumed();
+      s.priority = qos & 0x7;
+      uint16_t key = s.fragKey;
+      if (!s.fragActive) {
+        // The first fragment starts with the header of the fragmented message.
+        Unit inner = {0, kControlKey, 0, kControlKey, 0, 0};
+        Result result = ParseNetwork(s, p + header, len - header, inner);
+        if (result == NEED_MORE) {
+          return NEED_MORE;
+        }
+        key = result == OK ? inner.key : kControlKey;
+        if (result == OK) {
+          unit.payload = inner.payload;
+          unit.payloadOffset = inner.length;
+        }
+      }
+      s.fragActive = (h & kFlag6) != 0;
+      s.fragKey = key;
+      s.inFrame = false;
+      unit.length = header;
+      unit.key = key;
+      unit.skip = s.batchLeft - header;
+      unit.skipKey = key;
+      return OK;
+    }
+
+    case kTransportOam:
+    case 0x01:  // INIT
+    case 0x02:  // OPEN
+    case 0x03:  // CLOSE
+    case kKeepAlive:
+    case kJoin:
+      // Session management; nothing in the rest of the batch is data.
+      s.inFrame = false;
+      unit.length = 1;
+      unit.skip = s.batchLeft - 1;
+      return OK;
+
+    default:
+      return FAIL;
+  }
+}
+
+ZenohFlowParser::Result ZenohFlowParser::ParseNetwork(Stream& s,
+                                                      const uint8_t* p,
+                                                      uint32_t len,
+                                                      Unit& unit) {
+  Reader r(p, len);
+  uint8_t h = r.U8();
+  uint16_t scope = 0;
+  const uint8_t* suffix = nullptr;
+  uint32_t suffixLen = 0;
+  uint64_t skip = 0;
+  bool isPush = false;
+  bool declares = false;
+  bool undeclares = false;
+  uint16_t expr = 0;
+
+  switch (h & 0x1f) {
+    case kPush: {
+      isPush = true;
+      r.WireExpr(h & kFlag5, scope, suffix, suffixLen);
+      if (h & kFlagZ) {
+        r.Extensions();
+      }
+      uint8_t body = r.U8();
+      if ((body & 0x1f) != kPut && (body & 0x1f) != kDel) {
+        r.Fail();
+      }
+      if (body & kFlag5) {
+        r.Z64();  // timestamp: NTP64 time and the source zid
+        r.Bytes(r.Z64());
+      }
+      if ((body & 0x1f) == kPut && (body & kFlag6)) {
+        uint64_t encoding = r.Z64();
+        if (encoding & 1) {
+          r.Bytes(r.Z64());  // schema
+        }
+      }
+      if (body & kFlagZ) {
+        r.Extensions();
+      }
+      if ((body & 0x1f) == kPut) {
+        skip = r.Z64();
+      }
+      break;
+    }
+
+    case kDeclare: {
+      if (h & kFlag5) {
+        r.Z64();  // interest id
+      }
+      if (h & kFlagZ) {
+        r.Extensions();
+      }
+      uint8_t decl = r.U8();
+      uint8_t kind = decl & 0x1f;
+      if (kind == kDeclKeyExpr || kind == kUndeclKeyExpr) {
+        uint64_t id = r.Z64();
+        if (id > 0xffff) {
+          r.Fail();
+        }
+        expr = static_cast<uint16_t>(id);
+        declares = kind == kDeclKeyExpr;
+        undeclares = kind == kUndeclKeyExpr;
+        if (declares) {
+          r.WireExpr(decl & kFlag5, scope, suffix, suffixLen);
+        }
+      } else if (kind > kUndeclKeyExpr && kind <= kUndeclToken) {
+        r.Z64();  // entity id
+        if (kind % 2 == 0) {  // subscriber, queryable or token declarations
+          const uint8_t* ignored;
+          uint32_t ignoredLen;
+          uint16_t ignoredScope;
+          r.WireExpr(decl & kFlag5, ignoredScope, ignored, ignoredLen);
+        }
+      } else if (kind != kDeclFinal) {
+        r.Fail();
+      }
+      if (decl & kFlagZ) {
+        r.Extensions();
+      }
+      break;
+    }
+
+    case kNetworkOam:
+      r.Z64();  // OAM id, e.g. the routers' link state
+      if (h & kFlagZ) {
+        r.Extensions();
+      }
+      switch ((h >> 5) & 0x3) {
+        case 0:
+          break;
+        case 1:
+          r.Z64();
+          break;
+        case 2:
+          skip = r.Z64();
+          break;
+        default:
+          r.Fail();
+      }
+      break;
+
+    case kInterest:
+      r.Z64();  // interest id
+      if (h & (kFlag5 | kFlag6)) {  // not a final interest: options follow
+        uint8_t options = r.U8();
+        if (options & 0x10) {  // restricted to a key expression
+          const uint8_t* ignored;
+          uint32_t ignoredLen;
+          uint16_t ignoredScope;
+          r.WireExpr(options & 0x20, ignoredScope, ignored, ignoredLen);
+        }
+      }
+      if (h & kFlagZ) {
+        r.Extensions();
+      }
+      break;
+
+    case kResponseFinal:
+      r.Z64();  // request id
+      if (h & kFlagZ) {
+        r.Extensions();
+      }
+      break;
+
+    default:
+      // REQUEST and RESPONSE carry queries, which these experiments do not use.
+      return FAIL;
+  }
+
+  if (r.state != Reader::GOOD) {
+    return r.state == Reader::SHORT ? NEED_MORE : FAIL;
+  }
+  if (skip > 0xffffffffu) {
+    return FAIL;
+  }
+
+  unit.length = r.Consumed();
+  unit.skip = static_cast<uint32_t>(skip);
+  if (isPush) {
+    uint16_t key = Resolve(s, scope, h & kFlag6, suffix, suffixLen);
+    unit.key = key;
+    unit.skipKey = key;
+    unit.payload = unit.skip;
+  } else if (declares) {
+    // The scope of a declaration refers to the receiver's mappings.
+    Declare(s, expr, Resolve(s, scope, false, suffix, suffixLen));
+  } else if (undeclares) {
+    Undeclare(s, expr);
+  }
+  return OK;
+}
+
+uint16_t ZenohFlowParser::Resolve(Stream& s,
+                                  uint16_t scope,
+                                  bool senderMapping,
+                                  const uint8_t* suffix,
+                                  uint32_t suffixLen) {
+  if (scope == 0) {
+    return Intern(reinterpret_cast<const char*>(suffix), suffixLen);
+  }
+  // Sender mappings were declared on this stream, receiver mappings by the
+  // peer on the reverse stream.
+  Stream* owner = senderMapping ? &s : FindStream(s.dstIp, s.srcIp, s.dstPort, s.srcPort, false);
+  if (!owner) {
+    return kUnknownKey;
+  }
+  for (uint32_t i = 0; i < owner->nMappings; ++i) {
+    if (owner->mappings[i].expr == scope) {
+      uint16_t prefix = owner->mappings[i].key;
+      if (suffixLen == 0 || prefix == kUnknownKey) {
+        return prefix;
+      }
+      uint32_t prefixLen = m_keyLengths[prefix];
+      if (prefixLen + suffixLen >= kMaxKeyLength) {
+        return kUnknownKey;
+      }
+      char key[kMaxKeyLength];
+      std::memcpy(key, &m_keyChars[static_cast<size_t>(prefix) * kMaxKeyLength], prefixLen);
+      std::memcpy(key + prefixLen, suffix, suffixLen);
+      return Intern(key, prefixLen + suffixLen);
+    }
+  }
+  return kUnknownKey;
+}
+
+void ZenohFlowParser::Declare(Stream& s, uint16_t expr, uint16_t key) {
+  for (uint32_t i = 0; i < s.nMappings; ++i) {
+    if (s.mappings[i].expr == expr) {
+      s.mappings[i].key = key;
+      return;
+    }
+  }
+  if (s.nMappings < kMappings) {
+    s.mappings[s.nMappings++] = Mapping{expr, key};
+  }
+}
+
+void ZenohFlowParser::Undeclare(Stream& s, uint16_t expr) {
+  for (uint32_t i = 0; i < s.nMappings; ++i) {
+    if (s.mappings[i].expr == expr) {
+      s.mappings[i] = s.mappings[--s.nMappings];
+      return;
+    }
+  }
+}
+
+}  // namespace ns3
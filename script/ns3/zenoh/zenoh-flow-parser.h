@@ -0,0 +1,200 @@
+#ifndef ZENOH_SIM_ZENOH_FLOW_PARSER_H
+#define ZENOH_SIM_ZENOH_FLOW_PARSER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * Passive Zenoh-over-TCP decoder that attributes the bytes of every observed
+ * TCP stream to key expressions.
+ *
+ * Each stream is followed in sequence order (retransmissions are trimmed) and
+ * split into Zenoh batches using their 2-byte length prefix. Inside a batch
+ * the parser reads transport FRAME/FRAGMENT headers and the network messages
+ * in them: PUSH gives the key expression of a publication, DECLARE keyexpr
+ * keeps the per-session id -> key mapping needed to resolve PUSHes that only
+ * carry a numeric scope. Payloads are skipped by length, never copied.
+ *
+ * Anything that cannot be decoded (queries, unknown messages, a header that
+ * does not fit the per-stream carry buffer) is counted as control traffic up
+ * to the end of its batch, where parsing picks up again. A stream joined in
+ * the middle, or with a hole in the sequence space, resynchronizes at the
+ * first segment that starts with a plausible batch.
+ *
+ * Compressed batches (negotiated per session, off by default) are not
+ * supported.
+ *
+ * Optionally the parser also fingerprints PUT payloads, see
+ * SetPayloadCallback.
+ *
+ * All state lives in tables sized at construction; OnFrame never allocates.
+ */
+class ZenohFlowParser {
+ public:
+  /// Bytes that are not part of a PUSH: transport, declarations, link state...
+  static const uint16_t kControlKey = 0;
+  /// PUSHes whose key expression cannot be resolved.
+  static const uint16_t kUnknownKey = 1;
+  /// GetFramePriority when the frame carried no recognized batch bytes.
+  static const uint8_t kNoPriority = 0xff;
+
+  /// Direction, key and fingerprint of a PUT payload seen in a frame.
+  using PayloadCallback = std::function<void(uint32_t dir, uint16_t key, uint64_t fingerprint)>;
+
+  struct Stats {
+    uint64_t frames = 0;
+    uint64_t streams = 0;
+    uint64_t resyncs = 0;  ///< batch framing found without seeing the SYN
+    uint64_t unparsedBytes = 0;  ///< counted as control because decoding gave up
+    uint64_t streamTableFull = 0;  ///< streams evicted to make room for a new one
+    uint64_t keyTableFull = 0;
+  };
+
+  /**
+   * @param directions number of directions frames can be observed on
+   * @param maxStreams TCP streams tracked at the same time. A stream is
+   *        released on FIN or RST; when the table is full anyway, the
+   *        least recently seen stream makes room.
+   * @param maxKeys distinct key expressions, including the two reserved ones
+   */
+  ZenohFlowParser(uint32_t directions, uint32_t maxStreams = 1024, uint32_t maxKeys = 1024);
+
+  /**
+   * Feeds one Ethernet frame observed on direction `dir`. `captured` bytes of
+   * the `size`-byte frame are available. Returns false, without consuming
+   * anything, when the parser needs the whole frame: call again with it.
+   * Lets the caller copy only the headers of bulk payload segments.
+   */
+  bool OnFrame(uint32_t dir, const uint8_t* frame, uint32_t captured, uint32_t size);
+
+  /**
+   * Calls `cb` from OnFrame for every PUT, during the frame that holds the
+   * end of the payload's first `bytes` bytes (0: all of it). The fingerprint
+   * hashes those bytes and the payload length. Routers copy payloads
+   * unchanged, so the same put gives the same fingerprint on every link,
+   * however TCP segments or batches it there. Of a fragmented put, only the
+   * first fragment is hashed. Frames that start or finish a fingerprint
+   * have to be passed whole (OnFrame returns false otherwise).
+   */
+  void SetPayloadCallback(uint32_t bytes, PayloadCallback cb);
+
+  uint32_t GetNKeys() const { return m_nKeys; }
+  std::string GetKey(uint16_t key) const;
+  uint32_t GetNDirections() const { return m_directions; }
+
+  /**
+   * Most urgent Zenoh priority (0 Control ... 7 Background) among the
+   * batches the last OnFrame call carried bytes of. It comes from the QoS
+   * extension of the batch's FRAME or FRAGMENT, and is 5 (Data) without one.
+   */
+  uint8_t GetFramePriority() const { return m_framePriority; }
+
+  /// Bytes attributed to (key, dir) since the last TakeBytes of that cell.
+  uint64_t TakeBytes(uint16_t key, uint32_t dir) {
+    uint64_t& cell = m_bytes[static_cast<size_t>(key) * m_directions + dir];
+    uint64_t value = cell;
+    cell = 0;
+    return value;
+  }
+
+  const Stats& GetStats() const { return m_stats; }
+
+ private:
+  static const uint32_t kPending = 2048;
+  static const uint32_t kMappings = 128;
+  static const uint32_t kMaxKeyLength = 256;
+
+  struct Mapping {
+    uint16_t expr;
+    uint16_t key;
+  };
+
+  struct Stream {
+    bool used;
+    uint32_t srcIp;
+    uint32_t dstIp;
+    uint16_t srcPort;
+    uint16_t dstPort;
+    uint32_t dir;
+    uint64_t lastSeen;  ///< Stats::frames when the stream last had a segment
+
+    bool synced;
+    uint32_t nextSeq;
+    uint32_t batchLeft;  ///< bytes left in the current batch, 0: length prefix next
+    bool inFrame;
+    uint32_t skip;  ///< body bytes to pass over, attributed to skipKey
+    uint16_t skipKey;
+    bool fragActive;  ///< inside a fragmented message
+    uint16_t fragKey;
+    uint32_t failures;  ///< batches given up in a row
+    uint8_t priority;   ///< of the current batch, kNoPriority until its header is seen
+
+    uint32_t fpDelay;  ///< skipped bytes before the payload to fingerprint starts
+    uint32_t fpLeft;   ///< payload bytes still to hash, 0: no fingerprint pending
+    uint16_t fpKey;
+    uint64_t fpHash;
+
+    uint32_t nMappings;
+    Mapping mappings[kMappings];
+    uint32_t pendingLen;
+    uint8_t pending[kPending];  ///< start of a unit that straddles segments
+  };
+
+  enum Result { OK, NEED_MORE, FAIL };
+
+  /// Outcome of decoding one unit (length prefix, transport or network message).
+  struct Unit {
+    uint32_t length;   ///< bytes consumed
+    uint16_t key;      ///< key the consumed bytes belong to
+    uint32_t skip;     ///< body bytes following the unit
+    uint16_t skipKey;
+    uint32_t payload;        ///< length of a PUT payload in the skipped bytes, 0: none
+    uint32_t payloadOffset;  ///< skipped bytes before that payload
+  };
+
+  uint32_t HomeSlot(uint32_t srcIp, uint32_t dstIp, uint16_t srcPort, uint16_t dstPort) const;
+  Stream* FindStream(uint32_t srcIp, uint32_t dstIp, uint16_t srcPort, uint16_t dstPort,
+                     bool create);
+  void ReleaseStream(Stream& s);
+  void ResetStream(Stream& s, uint32_t nextSeq);
+  void Feed(Stream& s, const uint8_t* data, uint32_t len);
+  bool Resync(Stream& s, const uint8_t* data, uint32_t len);
+  void GiveUpBatch(Stream& s);
+  void Fingerprint(Stream& s, const uint8_t* data, uint32_t len);
+  void NotePriority(const Stream& s) { m_framePriority = std::min(m_framePriority, s.priority); }
+
+  Result ParseUnit(Stream& s, const uint8_t* p, uint32_t len, Unit& unit);
+  Result ParseNetwork(Stream& s, const uint8_t* p, uint32_t len, Unit& unit);
+
+  uint16_t Resolve(Stream& s, uint16_t scope, bool senderMapping, const uint8_t* suffix,
+                   uint32_t suffixLen);
+  uint16_t Intern(const char* key, uint32_t len);
+  void Declare(Stream& s, uint16_t expr, uint16_t key);
+  void Undeclare(Stream& s, uint16_t expr);
+
+  void Account(uint32_t dir, uint16_t key, uint32_t bytes) {
+    m_bytes[static_cast<size_t>(key) * m_directions + dir] += bytes;
+  }
+
+  uint32_t m_directions;
+  std::vector<Stream> m_streams;
+  uint32_t m_maxKeys;
+  uint32_t m_nKeys;
+  std::vector<char> m_keyChars;
+  std::vector<uint16_t> m_keyLengths;
+  std::vector<uint32_t> m_keySlots;  ///< open addressing, key id + 1, 0: empty
+  std::vector<uint64_t> m_bytes;     ///< [key * directions + dir]
+  Stats m_stats;
+  uint32_t m_fpBytes;
+  PayloadCallback m_payloadCallback;
+  uint8_t m_framePriority;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_ZENOH_FLOW_PARSER_H
@@ -0,0 +1,56 @@
+#include "zenoh-model-header.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED(ZenohModelHeader);
+
+TypeId ZenohModelHeader::GetTypeId() {
+  static TypeId tid = TypeId("ns3::ZenohModelHeader")
+                          .SetParent<Header>()
+                          .AddConstructor<ZenohModelHeader>();
+  return tid;
+}
+
+TypeId ZenohModelHeader::GetInstanceTypeId() const {
+  return GetTypeId();
+}
+
+uint32_t ZenohModelHeader::GetSerializedSize() const {
+  return 28;
+}
+
+void ZenohModelHeader::Serialize(Buffer::Iterator start) const {
+  start.WriteU8(kind);
+  start.WriteU8(priority);
+  start.WriteU8(hops);
+  start.WriteU8(0);
+  start.WriteHtonU16(key);
+  start.WriteHtonU16(origin);
+  start.WriteHtonU32(id);
+  start.WriteHtonU16(frag);
+  start.WriteHtonU16(nFrags);
+  start.WriteHtonU32(bytes);
+  start.WriteHtonU64(static_cast<uint64_t>(pubNs));
+}
+
+uint32_t ZenohModelHeader::Deserialize(Buffer::Iterator start) {
+  kind = start.ReadU8();
+  priority = start.ReadU8();
+  hops = start.ReadU8();
+  start.ReadU8();
+  key = start.ReadNtohU16();
+  origin = start.ReadNtohU16();
+  id = start.ReadNtohU32();
+  frag = start.ReadNtohU16();
+  nFrags = start.ReadNtohU16();
+  bytes = start.ReadNtohU32();
+  pubNs = static_cast<int64_t>(start.ReadNtohU64());
+  return GetSerializedSize();
+}
+
+void ZenohModelHeader::Print(std::ostream& os) const {
+  os << "kind=" << +kind << " prio=" << +priority << " key=" << key << " origin=" << origin
+     << " id=" << id << " frag=" << frag << "/" << nFrags << " bytes=" << bytes;
+}
+
+}  // namespace ns3
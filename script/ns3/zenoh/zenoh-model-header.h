@@ -0,0 +1,38 @@
+#ifndef ZENOH_SIM_ZENOH_MODEL_HEADER_H
+#define ZENOH_SIM_ZENOH_MODEL_HEADER_H
+
+#include "ns3/header.h"
+
+#include <cstdint>
+
+namespace ns3 {
+
+/**
+ * Header of the frames ZenohModel sends over the links: one fragment of a
+ * modelled Zenoh message plus everything needed to rebuild the message at
+ * the next hop. 28 bytes, in network byte order.
+ */
+class ZenohModelHeader : public Header {
+ public:
+  static TypeId GetTypeId();
+  TypeId GetInstanceTypeId() const override;
+  uint32_t GetSerializedSize() const override;
+  void Serialize(Buffer::Iterator start) const override;
+  uint32_t Deserialize(Buffer::Iterator start) override;
+  void Print(std::ostream& os) const override;
+
+  uint8_t kind = 0;
+  uint8_t priority = 0;
+  uint8_t hops = 0;
+  uint16_t key = 0;
+  uint16_t origin = 0;  ///< node that published or announced the message
+  uint32_t id = 0;
+  uint16_t frag = 0;
+  uint16_t nFrags = 1;
+  uint32_t bytes = 0;  ///< size of the whole message
+  int64_t pubNs = 0;   ///< simulation time of the put
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_ZENOH_MODEL_HEADER_H
@@ -0,0 +1,645 @@
+#include "zenoh-model.h"
+
+#include "ns3/abort.h"
+#include "ns3/callback.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE("ZenohModel");
+
+namespace {
+
+const char* const kKeyNames[] = {
+    "demo/example/zenoh-rs-pub1",
+    "demo/example/zenoh-rs-pub-realtime",
+    "demo/example/zenoh-rs-pub2",
+};
+const uint16_t kKeyPub1 = 0;
+const uint16_t kKeyRealtime = 1;
+const uint16_t kKeyPub2 = 2;
+
+/// Fixed part of a control message besides its body.
+const uint32_t kControlBytes = 8;
+
+double Mbps(uint64_t bytes, Time interval) {
+  return bytes * 8 / interval.GetSeconds() / 1e6;
+}
+
+}  // namespace
+
+ZenohModel::ZenohModel(EmulatedTopology& topology,
+                       const ZenohModelParams& params,
+                       const std::string& outputDir)
+    : m_topology(topology),
+      m_params(params),
+      m_outputDir(outputDir),
+      m_incomplete(0),
+      m_sendFailures(0),
+      m_linkStates(0),
+      m_blocks(0),
+      m_recovers(0),
+      m_pins(0) {}
+
+void ZenohModel::Start() {
+  const NetworkConfig& config = m_topology.GetConfig();
+  uint32_t nNodes = config.nodes.size();
+  m_nodes.resize(nNodes);
+  for (uint32_t n = 0; n < nNodes; ++n) {
+    NodeState& node = m_nodes[n];
+    node.id = config.nodes[n].id;
+    node.router = config.nodes[n].role == "router";
+    node.pub = config.nodes[n].role == "pub";
+    node.sub = config.nodes[n].role == "sub";
+    node.seq.assign(nNodes, 0);
+    node.dataTrees.resize(nNodes);
+    node.nextId = 0;
+    if (node.sub) {
+      m_subs.push_back(n);
+    }
+  }
+  NS_ABORT_MSG_IF(m_subs.empty() || std::none_of(m_nodes.begin(), m_nodes.end(),
+                                                 [](const NodeState& s) { return s.pub; }),
+                  "simulation needs at least one node with role pub and one with role sub");
+  m_delivery.resize(m_subs.size() * kKeys);
+  m_controlTrees.resize(nNodes);
+
+  // Ports are created first and never move, the traces point into m_ports.
+  m_portOf.resize(m_topology.GetNodes().GetN());
+  for (auto& link : m_topology.GetLinks()) {
+    for (uint32_t side = 0; side < 2; ++side) {
+      Port port{};
+      port.model = this;
+      port.index = m_ports.size();
+      port.node = config.NodeIndex(link.ends[side].nodeId);
+      port.peer = config.NodeIndex(link.ends[1 - side].nodeId);
+      port.link = link.index;
+      port.device = link.ends[side].device;
+      port.peerAddress = link.ends[1 - side].device->GetAddress();
+      PointerValue queue;
+      port.device->GetAttribute("TxQueue", queue);
+      port.queue = queue.Get<Queue<Packet>>();
+      port.capMbps = link.config.capMbps;
+      m_nodes[port.node].ports.push_back(port.index);
+      std::vector<uint32_t>& byIf = m_portOf[port.device->GetNode()->GetId()];
+      byIf.resize(std::max<size_t>(byIf.size(), port.device->GetIfIndex() + 1), kNone);
+      byIf[port.device->GetIfIndex()] = port.index;
+      m_ports.push_back(port);
+    }
+  }
+  for (NodeState& node : m_nodes) {
+    node.weights.assign(m_ports.size(), kDefaultWeight);
+  }
+  for (Port& port : m_ports) {
+    port.queue->TraceConnectWithoutContext("Dequeue",
+                                           MakeBoundCallback(&ZenohModel::OnDequeue, &port));
+    port.device->GetNode()->RegisterProtocolHandler(MakeCallback(&ZenohModel::OnFrame, this),
+                                                    kEtherType, port.device);
+  }
+
+  m_deliveryCsv.open(m_outputDir + "/sim_delivery.csv");
+  m_deliveryCsv << "sim_s,sub,key,msgs,mbps,latency_ms_mean,latency_ms_max\n";
+  m_linksCsv.open(m_outputDir + "/sim_links.csv");
+  m_linksCsv << "sim_s,link,from,to,data_mbps,high_mbps,queued_kb,data_weight\n";
+  m_eventsCsv.open(m_outputDir + "/sim_events.csv");
+  m_eventsCsv << "sim_s,node,kind,peer,detail\n";
+
+  for (uint32_t n = 0; n < m_nodes.size(); ++n) {
+    if (m_nodes[n].pub) {
+      Simulator::Schedule(m_params.pubStart, &ZenohModel::Publish, this, n);
+    }
+  }
+  Simulator::Schedule(m_params.metricsInterval, &ZenohModel::Metrics, this);
+  Simulator::Schedule(m_params.cleanupInterval, &ZenohModel::Cleanup, this);
+  Simulator::Schedule(Seconds(1), &ZenohModel::Report, this);
+}
+
+ZenohModel::MessagePtr ZenohModel::NewMessage(uint32_t node,
+                                              Kind kind,
+                                              uint8_t priority,
+                                              uint16_t key,
+                                              uint32_t bytes) {
+  auto msg = std::make_shared<Message>();
+  msg->header.kind = kind;
+  msg->header.priority = priority;
+  msg->header.key = key;
+  msg->header.origin = node;
+  msg->header.id = ++m_nodes[node].nextId;
+  msg->header.bytes = bytes;
+  msg->header.pubNs = Simulator::Now().GetNanoSeconds();
+  return msg;
+}
+
+void ZenohModel::Publish(uint32_t node) {
+  Time since = Simulator::Now() - m_params.pubStart;
+  uint16_t key = since < m_params.switchAfter ? kKeyPub1 : kKeyPub2;
+  auto bytes = static_cast<uint32_t>(m_params.pubMbps * 1e6 / 8 *
+                                     m_params.pubInterval.GetSeconds());
+  ++m_published[key];
+  Route(node, kNone, NewMessage(node, kPut, kData, key, bytes));
+  if (m_params.realtimeBytes > 0) {
+    ++m_published[kKeyRealtime];
+    Route(node, kNone,
+          NewMessage(node, kPut, kRealTime, kKeyRealtime, m_params.realtimeBytes));
+  }
+  Simulator::Schedule(m_params.pubInterval, &ZenohModel::Publish, this, node);
+}
+
+void ZenohModel::Route(uint32_t n, uint32_t inPort, const MessagePtr& msg) {
+  NodeState& node = m_nodes[n];
+  const ZenohModelHeader& h = msg->header;
+  if (node.sub && inPort != kNone) {
+    Subscribe(n, h);
+  }
+  if (h.hops >= kMaxHops) {
+    return;
+  }
+  bool data = h.priority > kRealTime;
+  const std::vector<uint32_t>* out =
+      &(data ? DataTree(n, h.origin) : ControlTree(h.origin)).down[n];
+  if (data && node.router) {
+    // Pinned flows ignore the data tree; every forwarded flow is recorded.
+    auto pin = node.pins.find(h.key);
+    if (pin != node.pins.end()) {
+      out = &pin->second;
+    }
+    Flow& flow = node.flows[h.key];
+    flow.prevPort = inPort;
+    flow.nextPorts = *out;
+    flow.lastUpdate = Simulator::Now();
+  }
+  for (uint32_t port : *out) {
+    if (port != inPort) {
+      Enqueue(port, msg);
+    }
+  }
+}
+
+void ZenohModel::Subscribe(uint32_t n, const ZenohModelHeader& h) {
+  uint32_t sub = std::find(m_subs.begin(), m_subs.end(), n) - m_subs.begin();
+  std::vector<bool>& seen = m_seen[static_cast<uint64_t>(sub) << 16 | h.origin];
+  if (seen.size() <= h.id) {
+    seen.resize(std::max<size_t>(h.id + 1, seen.size() * 2), false);
+  }
+  Delivery& d = m_delivery[sub * kKeys + h.key];
+  if (seen[h.id]) {
+    ++d.dups;
+    return;
+  }
+  seen[h.id] = true;
+  int64_t latency = Simulator::Now().GetNanoSeconds() - h.pubNs;
+  d.latency.Add(static_cast<uint64_t>(latency));
+  ++d.msgs;
+  ++d.windowMsgs;
+  d.windowBytes += h.bytes;
+  d.windowLatencySum += latency;
+  d.windowLatencyMax = std::max(d.windowLatencyMax, latency);
+}
+
+void ZenohModel::Enqueue(uint32_t p, const MessagePtr& msg) {
+  Port& port = m_ports[p];
+  const ZenohModelHeader& h = msg->header;
+  // Only data puts use CongestionControl::Drop, the rest blocks.
+  if (h.priority > kRealTime && port.queued[h.priority] + h.bytes > m_params.queueBytes) {
+    ++m_queueDrops[h.key];
+    return;
+  }
+  uint32_t maxPayload = port.device->GetMtu() - ZenohModelHeader().GetSerializedSize();
+  auto nFrags =
+      static_cast<uint16_t>(std::max<uint32_t>(1, (h.bytes + maxPayload - 1) / maxPayload));
+  NS_ABORT_MSG_IF(h.kind != kPut && nFrags > 1, "control message larger than one frame");
+  uint32_t left = h.bytes;
+  for (uint16_t frag = 0; frag < nFrags; ++frag) {
+    uint32_t payload = std::min(left, maxPayload);
+    port.tx[h.priority].push_back(Frame{msg, frag, nFrags, payload});
+    left -= payload;
+  }
+  port.queued[h.priority] += h.bytes;
+  Pump(p);
+}
+
+void ZenohModel::OnDequeue(Port* port, Ptr<const Packet>) {
+  // Called from inside the device's transmit path, so refill later.
+  if (!port->pumpScheduled) {
+    port->pumpScheduled = true;
+    Simulator::ScheduleNow(&ZenohModel::Pump, port->model, port->index);
+  }
+}
+
+void ZenohModel::Pump(uint32_t p) {
+  Port& port = m_ports[p];
+  port.pumpScheduled = false;
+  // One frame on the wire and one waiting in the device queue, the rest
+  // stays in the priority queues so that later high-priority frames overtake.
+  while (port.queue->GetNPackets() == 0) {
+    uint32_t prio = 0;
+    while (prio < kPriorities && port.tx[prio].empty()) {
+      ++prio;
+    }
+    if (prio == kPriorities) {
+      return;
+    }
+    Frame frame = port.tx[prio].front();
+    port.tx[prio].pop_front();
+    port.queued[prio] -= frame.payload;
+
+    Ptr<Packet> packet;
+    if (frame.msg->body.empty()) {
+      packet = Create<Packet>(frame.payload);
+    } else {
+      std::vector<uint8_t> buf(frame.payload, 0);
+      for (size_t i = 0; i < frame.msg->body.size(); ++i) {
+        buf[2 * i] = frame.msg->body[i] >> 8;
+        buf[2 * i + 1] = frame.msg->body[i] & 0xff;
+      }
+      packet = Create<Packet>(buf.data(), buf.size());
+    }
+    ZenohModelHeader h = frame.msg->header;
+    h.frag = frame.frag;
+    h.nFrags = frame.nFrags;
+    ++h.hops;
+    packet->AddHeader(h);
+    port.sent[prio] += packet->GetSize();
+    port.window[prio] += packet->GetSize();
+    if (!port.device->Send(packet, port.peerAddress, kEtherType)) {
+      ++m_sendFailures;  // link down
+    }
+  }
+}
+
+void ZenohModel::OnFrame(Ptr<NetDevice> device,
+                         Ptr<const Packet> packet,
+                         uint16_t,
+                         const Address&,
+                         const Address&,
+                         NetDevice::PacketType) {
+  uint32_t p = m_portOf[device->GetNode()->GetId()][device->GetIfIndex()];
+  Port& port = m_ports[p];
+  Ptr<Packet> copy = packet->Copy();
+  ZenohModelHeader h;
+  copy->RemoveHeader(h);
+  if (h.priority >= kPriorities) {
+    return;
+  }
+
+  // Frames of one priority arrive in order; a gap (loss) discards the message.
+  ZenohModelHeader& cur = port.rx[h.priority];
+  uint16_t& next = port.rxNext[h.priority];
+  if (h.frag == 0) {
+    m_incomplete += next != 0;
+    cur = h;
+    next = 1;
+  } else if (next != 0 && h.frag == next && h.origin == cur.origin && h.id == cur.id) {
+    ++next;
+  } else {
+    m_incomplete += next != 0;
+    next = 0;
+    return;
+  }
+  if (next < h.nFrags) {
+    return;
+  }
+  next = 0;
+
+  auto msg = std::make_shared<Message>();
+  msg->header = h;
+  if (h.kind != kPut) {
+    std::vector<uint8_t> buf(copy->GetSize());
+    copy->CopyData(buf.data(), buf.size());
+    uint32_t n = (h.bytes - kControlBytes) / 2;
+    msg->body.resize(n);
+    for (uint32_t i = 0; i < n; ++i) {
+      msg->body[i] = static_cast<uint16_t>(buf[2 * i] << 8 | buf[2 * i + 1]);
+    }
+  }
+  Dispatch(port.node, p, msg);
+}
+
+void ZenohModel::Dispatch(uint32_t node, uint32_t inPort, const MessagePtr& msg) {
+  switch (msg->header.kind) {
+    case kPut:
+      Route(node, inPort, msg);
+      break;
+    case kLinkState:
+      OnLinkState(node, inPort, msg);
+      break;
+    case kPinFlows:
+      OnPinFlows(node, inPort, msg);
+      break;
+  }
+}
+
+ZenohModel::Tree ZenohModel::ComputeTree(const std::vector<uint16_t>& weights,
+                                         uint32_t source) const {
+  // Bellman-Ford over the directed link ends; the weight of a port is the one
+  // announced by the node that sends on it.
+  const uint64_t inf = std::numeric_limits<uint64_t>::max();
+  uint32_t n = m_nodes.size();
+  std::vector<uint64_t> dist(n, inf);
+  std::vector<uint32_t> parent(n, kNone);
+  dist[source] = 0;
+  for (uint32_t round = 1; round < n; ++round) {
+    bool changed = false;
+    for (const Port& port : m_ports) {
+      if (dist[port.node] != inf && dist[port.node] + weights[port.index] < dist[port.peer]) {
+        dist[port.peer] = dist[port.node] + weights[port.index];
+        parent[port.peer] = port.index;
+        changed = true;
+      }
+    }
+    if (!changed) {
+      break;
+    }
+  }
+
+  // Children before parents: mark every branch that leads to a subscriber.
+  std::vector<uint32_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return dist[a] > dist[b]; });
+  std::vector<uint8_t> hasSub(n, 0);
+  Tree tree;
+  tree.valid = true;
+  tree.down.resize(n);
+  for (uint32_t v : order) {
+    hasSub[v] |= m_nodes[v].sub;
+    if (parent[v] != kNone && hasSub[v]) {
+      uint32_t up = m_ports[parent[v]].node;
+      hasSub[up] = 1;
+      tree.down[up].push_back(parent[v]);
+    }
+  }
+  return tree;
+}
+
+const ZenohModel::Tree& ZenohModel::DataTree(uint32_t node, uint32_t source) {
+  Tree& tree = m_nodes[node].dataTrees[source];
+  if (!tree.valid) {
+    tree = ComputeTree(m_nodes[node].weights, source);
+  }
+  return tree;
+}
+
+const ZenohModel::Tree& ZenohModel::ControlTree(uint32_t source) {
+  Tree& tree = m_controlTrees[source];
+  if (!tree.valid) {
+    tree = ComputeTree(std::vector<uint16_t>(m_ports.size(), kDefaultWeight), source);
+  }
+  return tree;
+}
+
+void ZenohModel::Metrics() {
+  Time interval = m_params.metricsInterval;
+  for (uint32_t n = 0; n < m_nodes.size(); ++n) {
+    NodeState& node = m_nodes[n];
+    if (!node.router) {
+      continue;
+    }
+    bool changed = false;
+    bool blocked = false;
+    for (uint32_t p : node.ports) {
+      Port& port = m_ports[p];
+      uint64_t high = port.sent[kControl] + port.sent[kRealTime];
+      uint64_t all = std::accumulate(port.sent.begin(), port.sent.end(), uint64_t(0));
+      double dataMbps = Mbps(all - high, interval);
+      double capLimit = port.capMbps - Mbps(high, interval) - m_params.capBufferMbps;
+      double threshold = m_params.blockMbps > 0 ? m_params.blockMbps : capLimit;
+      std::ostringstream detail;
+      detail << "data=" << dataMbps << "Mbps threshold=" << threshold << "Mbps";
+      if (!port.blocked && dataMbps > threshold) {
+        port.blocked = true;
+        node.weights[p] = kBlockWeight;
+        changed = blocked = true;
+        ++m_blocks;
+        LogEvent(n, "block", m_nodes[port.peer].id, detail.str());
+        NS_LOG_INFO("t=" << Simulator::Now().GetSeconds() << "s " << node.id << " blocks "
+                         << m_nodes[port.peer].id << " (" << detail.str() << ")");
+      } else if (port.blocked && dataMbps < m_params.recoverFraction * threshold) {
+        port.blocked = false;
+        node.weights[p] = kDefaultWeight;
+        changed = true;
+        ++m_recovers;
+        LogEvent(n, "recover", m_nodes[port.peer].id, detail.str());
+        NS_LOG_INFO("t=" << Simulator::Now().GetSeconds() << "s " << node.id << " recovers "
+                         << m_nodes[port.peer].id << " (" << detail.str() << ")");
+      }
+    }
+    if (changed) {
+      FloodLinkState(n);
+    }
+    if (blocked && m_params.pinning) {
+      PinActiveFlows(n);
+    }
+  }
+  for (Port& port : m_ports) {
+    port.sent.fill(0);
+  }
+  Simulator::Schedule(interval, &ZenohModel::Metrics, this);
+}
+
+void ZenohModel::FloodLinkState(uint32_t n) {
+  NodeState& node = m_nodes[n];
+  auto msg = std::make_shared<Message>();
+  msg->header.kind = kLinkState;
+  msg->header.priority = kControl;
+  msg->header.origin = n;
+  msg->header.id = ++node.seq[n];
+  for (uint32_t p : node.ports) {
+    msg->body.push_back(node.weights[p]);
+  }
+  msg->header.bytes = kControlBytes + 2 * msg->body.size();
+  for (Tree& tree : node.dataTrees) {
+    tree.valid = false;
+  }
+  for (uint32_t p : node.ports) {
+    Enqueue(p, msg);
+  }
+}
+
+void ZenohModel::OnLinkState(uint32_t n, uint32_t inPort, const MessagePtr& msg) {
+  NodeState& node = m_nodes[n];
+  const ZenohModelHeader& h = msg->header;
+  if (!node.router || h.id <= node.seq[h.origin]) {
+    return;
+  }
+  ++m_linkStates;
+  node.seq[h.origin] = h.id;
+  const std::vector<uint32_t>& ports = m_nodes[h.origin].ports;
+  for (uint32_t i = 0; i < ports.size() && i < msg->body.size(); ++i) {
+    node.weights[ports[i]] = msg->body[i];
+  }
+  for (Tree& tree : node.dataTrees) {
+    tree.valid = false;
+  }
+  for (uint32_t p : node.ports) {
+    if (p != inPort) {
+      Enqueue(p, msg);
+    }
+  }
+}
+
+void ZenohModel::PinActiveFlows(uint32_t n) {
+  NodeState& node = m_nodes[n];
+  std::unordered_map<uint32_t, std::vector<uint16_t>> upstream;
+  for (const auto& entry : node.flows) {
+    const Flow& flow = entry.second;
+    if (Simulator::Now() - flow.lastUpdate > m_params.flowTtl) {
+      continue;
+    }
+    if (node.pins.emplace(entry.first, flow.nextPorts).second) {
+      ++m_pins;
+      LogEvent(n, "pin", "", kKeyNames[entry.first]);
+    }
+    if (flow.prevPort != kNone) {
+      upstream[flow.prevPort].push_back(entry.first);
+    }
+  }
+  SendPins(n, upstream);
+}
+
+void ZenohModel::OnPinFlows(uint32_t n, uint32_t, const MessagePtr& msg) {
+  NodeState& node = m_nodes[n];
+  if (!node.router) {
+    return;
+  }
+  std::unordered_map<uint32_t, std::vector<uint16_t>> upstream;
+  for (uint16_t key : msg->body) {
+    auto flow = node.flows.find(key);
+    if (flow == node.flows.end() || !node.pins.emplace(key, flow->second.nextPorts).second) {
+      continue;
+    }
+    ++m_pins;
+    LogEvent(n, "pin", m_nodes[msg->header.origin].id, kKeyNames[key]);
+    if (flow->second.prevPort != kNone) {
+      upstream[flow->second.prevPort].push_back(key);
+    }
+  }
+  SendPins(n, upstream);
+}
+
+void ZenohModel::SendPins(uint32_t n,
+                          const std::unordered_map<uint32_t, std::vector<uint16_t>>& keys) {
+  for (const auto& entry : keys) {
+    auto msg = std::make_shared<Message>();
+    msg->header.kind = kPinFlows;
+    msg->header.priority = kControl;
+    msg->header.origin = n;
+    msg->body = entry.second;
+    msg->header.bytes = kControlBytes + 2 * msg->body.size();
+    Enqueue(entry.first, msg);
+  }
+}
+
+void ZenohModel::Cleanup() {
+  Time now = Simulator::Now();
+  for (uint32_t n = 0; n < m_nodes.size(); ++n) {
+    NodeState& node = m_nodes[n];
+    for (auto it = node.flows.begin(); it != node.flows.end();) {
+      it = now - it->second.lastUpdate > m_params.flowTtl ? node.flows.erase(it) : std::next(it);
+    }
+    for (auto it = node.pins.begin(); it != node.pins.end();) {
+      if (node.flows.count(it->first)) {
+        ++it;
+        continue;
+      }
+      LogEvent(n, "unpin", "", kKeyNames[it->first]);
+      it = node.pins.erase(it);
+    }
+  }
+  Simulator::Schedule(m_params.cleanupInterval, &ZenohModel::Cleanup, this);
+}
+
+void ZenohModel::Report() {
+  double now = Simulator::Now().GetSeconds();
+  for (uint32_t s = 0; s < m_subs.size(); ++s) {
+    for (uint32_t key = 0; key < kKeys; ++key) {
+      Delivery& d = m_delivery[s * kKeys + key];
+      if (d.windowMsgs == 0) {
+        continue;
+      }
+      m_deliveryCsv << now << "," << m_nodes[m_subs[s]].id << "," << kKeyNames[key] << ","
+                    << d.windowMsgs << "," << Mbps(d.windowBytes, Seconds(1)) << ","
+                    << d.windowLatencySum / 1e6 / d.windowMsgs << "," << d.windowLatencyMax / 1e6
+                    << "\n";
+      d.windowMsgs = d.windowBytes = 0;
+      d.windowLatencySum = d.windowLatencyMax = 0;
+    }
+  }
+  for (Port& port : m_ports) {
+    uint64_t high = port.window[kControl] + port.window[kRealTime];
+    uint64_t all = std::accumulate(port.window.begin(), port.window.end(), uint64_t(0));
+    uint64_t queued = std::accumulate(port.queued.begin(), port.queued.end(), uint64_t(0));
+    if (all > 0 || queued > 0) {
+      m_linksCsv << now << "," << m_topology.GetConfig().links[port.link].Name(port.link) << ","
+                 << m_nodes[port.node].id << "," << m_nodes[port.peer].id << ","
+                 << Mbps(all - high, Seconds(1)) << "," << Mbps(high, Seconds(1)) << ","
+                 << queued / 1024.0 << "," << m_nodes[port.node].weights[port.index] << "\n";
+    }
+    port.window.fill(0);
+  }
+  Simulator::Schedule(Seconds(1), &ZenohModel::Report, this);
+}
+
+void ZenohModel::LogEvent(uint32_t node,
+                          const char* kind,
+                          const std::string& peer,
+                          const std::string& detail) {
+  m_eventsCsv << Simulator::Now().GetSeconds() << "," << m_nodes[node].id << "," << kind << ","
+              << peer << "," << detail << "\n";
+}
+
+void ZenohModel::Finish() {
+  m_deliveryCsv.close();
+  m_linksCsv.close();
+  m_eventsCsv.close();
+
+  std::ofstream os(m_outputDir + "/sim_summary.json");
+  os << "{\n  \"sim_s\": " << Simulator::Now().GetSeconds() << ",\n  \"params\": {"
+     << "\"pub_mbps\": " << m_params.pubMbps
+     << ", \"pub_interval_ms\": " << m_params.pubInterval.GetMilliSeconds()
+     << ", \"switch_after_s\": " << m_params.switchAfter.GetSeconds()
+     << ", \"realtime_bytes\": " << m_params.realtimeBytes
+     << ", \"metrics_interval_s\": " << m_params.metricsInterval.GetSeconds()
+     << ", \"cap_buffer_mbps\": " << m_params.capBufferMbps
+     << ", \"block_mbps\": " << m_params.blockMbps
+     << ", \"recover_fraction\": " << m_params.recoverFraction
+     << ", \"flow_ttl_s\": " << m_params.flowTtl.GetSeconds()
+     << ", \"cleanup_interval_s\": " << m_params.cleanupInterval.GetSeconds()
+     << ", \"pinning\": " << (m_params.pinning ? "true" : "false")
+     << ", \"queue_bytes\": " << m_params.queueBytes << "},\n  \"blocks\": " << m_blocks
+     << ",\n  \"recovers\": " << m_recovers << ",\n  \"pins\": " << m_pins
+     << ",\n  \"linkstate_msgs\": " << m_linkStates << ",\n  \"incomplete_msgs\": " << m_incomplete
+     << ",\n  \"send_failures\": " << m_sendFailures << ",\n  \"keys\": [";
+  const char* sep = "\n";
+  for (uint32_t key = 0; key < kKeys; ++key) {
+    os << sep << "    {\"key\": \"" << kKeyNames[key] << "\", \"published\": " << m_published[key]
+       << ", \"queue_drops\": " << m_queueDrops[key] << ", \"subs\": {";
+    const char* inner = "";
+    for (uint32_t s = 0; s < m_subs.size(); ++s) {
+      const Delivery& d = m_delivery[s * kKeys + key];
+      double loss = m_published[key] ? 100.0 * (1 - double(d.msgs) / m_published[key]) : 0;
+      os << inner << "\"" << m_nodes[m_subs[s]].id << "\": {\"delivered\": " << d.msgs
+         << ", \"loss_pct\": " << loss << ", \"dups\": " << d.dups
+         << ", \"latency_ms\": {\"mean\": " << d.latency.Mean() / 1e6
+         << ", \"p50\": " << d.latency.Percentile(0.5) / 1e6
+         << ", \"p99\": " << d.latency.Percentile(0.99) / 1e6
+         << ", \"max\": " << d.latency.Max() / 1e6 << "}}";
+      inner = ", ";
+    }
+    os << "}}";
+    sep = ",\n";
+  }
+  os << "\n  ]\n}\n";
+
+  NS_LOG_UNCOND("model: " << m_blocks << " blocks, " << m_recovers << " recovers, " << m_pins
+                          << " pins, summary in " << m_outputDir << "/sim_summary.json");
+}
+
+}  // namespace ns3
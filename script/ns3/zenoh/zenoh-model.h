@@ -0,0 +1,227 @@
+#ifndef ZENOH_SIM_ZENOH_MODEL_H
+#define ZENOH_SIM_ZENOH_MODEL_H
+
+#include "emulated-topology.h"
+#include "log-histogram.h"
+#include "zenoh-model-header.h"
+
+#include "ns3/net-device.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+
+#include <array>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/// Knobs of ZenohModel. The defaults are the values of z_pub and of the modified zenohd.
+struct ZenohModelParams {
+  double pubMbps = 2;                    ///< rate of the data publishers
+  Time pubInterval = MilliSeconds(50);   ///< one put per publisher and interval
+  Time pubStart = Seconds(5);            ///< z_pub waits for its session first
+  Time switchAfter = Seconds(30);        ///< publisher stops and publisher2 starts
+  uint32_t realtimeBytes = 1024;         ///< put size of the realtime publisher
+  Time metricsInterval = Seconds(5);     ///< METRICS_INTERVAL_SECS of the monitor
+  double capBufferMbps = 1;              ///< `buffer` in cap_limit
+  double blockMbps = 0;                  ///< fixed block threshold (0: cap_limit)
+  double recoverFraction = 0.2;          ///< recover below this share of the threshold
+  Time flowTtl = Seconds(5);
+  Time cleanupInterval = Seconds(1);
+  bool pinning = true;
+  uint32_t queueBytes = 256 * 1024;  ///< Drop-policy TX queue per link and priority
+};
+
+/**
+ * Message-level model of the Zenoh deployment, for running experiments
+ * without containers and faster than real time.
+ *
+ * Every node of the topology runs one instance of the model on top of the
+ * emulator's links (frames with EtherType 0x88b5, so the links' rate, delay
+ * and scenario changes apply as usual):
+ *
+ *  - pub nodes behave like the modified z_pub: after `pubStart`, every
+ *    `pubInterval` a put of pubMbps * pubInterval on the data publisher
+ *    (demo/example/zenoh-rs-pub1, replaced by zenoh-rs-pub2 after
+ *    `switchAfter`) and one on the RealTime publisher.
+ *  - every link end has Zenoh's per-priority TX queues. Data puts are
+ *    dropped when their queue is full (CongestionControl::Drop), RealTime and
+ *    control messages wait (Block). Messages are cut into MTU-sized frames
+ *    and the highest priority goes first.
+ *  - routers forward RealTime traffic on the control trees (default
+ *    weights) and data on data trees, computed with Bellman-Ford from their
+ *    own view of the data link weights.
+ *  - every `metricsInterval` a router compares the data throughput it sent
+ *    to each peer with cap_limit = cap - high-priority throughput - buffer.
+ *    Above it the link's data weight becomes 65535, below `recoverFraction`
+ *    of it the weight returns to 100. Changes are flooded as linkstate
+ *    messages, so other routers see them after the links' delay.
+ *  - a router that blocks a link pins its active flows to their current next
+ *    hops and asks the upstream routers to do the same. Flows idle for
+ *    `flowTtl` are removed by a cleanup every `cleanupInterval`, which also
+ *    drops their pins.
+ *
+ * Output: sim_delivery.csv (per second, sub and key), sim_links.csv (per
+ * second and link direction), sim_events.csv (block, recover, pin, unpin) and
+ * sim_summary.json.
+ */
+class ZenohModel {
+ public:
+  ZenohModel(EmulatedTopology& topology,
+             const ZenohModelParams& params,
+             const std::string& outputDir);
+
+  /// Installs the model on every node and schedules the publishers and timers.
+  void Start();
+  void Finish();
+
+ private:
+  static constexpr uint32_t kPriorities = 8;
+  static constexpr uint8_t kControl = 0;
+  static constexpr uint8_t kRealTime = 1;
+  static constexpr uint8_t kData = 5;
+  static constexpr uint16_t kDefaultWeight = 100;
+  static constexpr uint16_t kBlockWeight = 65535;
+  static constexpr uint16_t kEtherType = 0x88b5;
+  static constexpr uint8_t kMaxHops = 64;
+  static constexpr uint32_t kNone = ~0u;
+  static constexpr uint32_t kKeys = 3;
+
+  enum Kind : uint8_t { kPut, kLinkState, kPinFlows };
+
+  struct Message {
+    ZenohModelHeader header;     ///< frag and nFrags are set per frame
+    std::vector<uint16_t> body;  ///< weights or keys of control messages
+  };
+  using MessagePtr = std::shared_ptr<const Message>;
+
+  struct Frame {
+    MessagePtr msg;
+    uint16_t frag;
+    uint16_t nFrags;
+    uint32_t payload;
+  };
+
+  /// One link end, i.e. the transport from `node` to `peer`.
+  struct Port {
+    ZenohModel* model;
+    uint32_t index;
+    uint32_t node;
+    uint32_t peer;
+    uint32_t link;
+    Ptr<NetDevice> device;
+    Address peerAddress;
+    Ptr<Queue<Packet>> queue;
+    double capMbps;
+    std::array<std::deque<Frame>, kPriorities> tx;
+    std::array<uint64_t, kPriorities> queued;  ///< payload bytes waiting in tx
+    std::array<uint64_t, kPriorities> sent;    ///< bytes since the last metrics round
+    std::array<uint64_t, kPriorities> window;  ///< bytes since the last report
+    bool blocked;
+    bool pumpScheduled;
+    std::array<ZenohModelHeader, kPriorities> rx;  ///< message being reassembled
+    std::array<uint16_t, kPriorities> rxNext;      ///< next fragment, 0: none
+  };
+
+  struct Tree {
+    bool valid = false;
+    std::vector<std::vector<uint32_t>> down;  ///< [node] ports leading to subscribers
+  };
+
+  struct Flow {
+    uint32_t prevPort;
+    std::vector<uint32_t> nextPorts;
+    Time lastUpdate;
+  };
+
+  struct NodeState {
+    std::string id;
+    bool router;
+    bool pub;
+    bool sub;
+    std::vector<uint32_t> ports;
+    std::vector<uint16_t> weights;  ///< data weight of every port, as this node knows it
+    std::vector<uint32_t> seq;      ///< last linkstate id per origin
+    std::vector<Tree> dataTrees;    ///< [source]
+    std::unordered_map<uint16_t, Flow> flows;
+    std::unordered_map<uint16_t, std::vector<uint32_t>> pins;
+    uint32_t nextId;
+  };
+
+  struct Delivery {
+    LogHistogram latency;
+    uint64_t msgs = 0;
+    uint64_t dups = 0;
+    uint64_t windowMsgs = 0;
+    uint64_t windowBytes = 0;
+    int64_t windowLatencySum = 0;
+    int64_t windowLatencyMax = 0;
+  };
+
+  static void OnDequeue(Port* port, Ptr<const Packet> packet);
+  void OnFrame(Ptr<NetDevice> device,
+               Ptr<const Packet> packet,
+               uint16_t protocol,
+               const Address& from,
+               const Address& to,
+               NetDevice::PacketType type);
+  void Dispatch(uint32_t node, uint32_t inPort, const MessagePtr& msg);
+  void Route(uint32_t node, uint32_t inPort, const MessagePtr& msg);
+  void Enqueue(uint32_t port, const MessagePtr& msg);
+  void Pump(uint32_t port);
+
+  void Publish(uint32_t node);
+  void Subscribe(uint32_t node, const ZenohModelHeader& header);
+  MessagePtr NewMessage(uint32_t node, Kind kind, uint8_t priority, uint16_t key, uint32_t bytes);
+
+  void Metrics();
+  void FloodLinkState(uint32_t node);
+  void OnLinkState(uint32_t node, uint32_t inPort, const MessagePtr& msg);
+  void PinActiveFlows(uint32_t node);
+  void OnPinFlows(uint32_t node, uint32_t inPort, const MessagePtr& msg);
+  void SendPins(uint32_t node, const std::unordered_map<uint32_t, std::vector<uint16_t>>& keys);
+  void Cleanup();
+  void Report();
+
+  const Tree& DataTree(uint32_t node, uint32_t source);
+  const Tree& ControlTree(uint32_t source);
+  Tree ComputeTree(const std::vector<uint16_t>& weights, uint32_t source) const;
+  void LogEvent(uint32_t node,
+                const char* kind,
+                const std::string& peer,
+                const std::string& detail);
+
+  EmulatedTopology& m_topology;
+  ZenohModelParams m_params;
+  std::string m_outputDir;
+
+  std::vector<NodeState> m_nodes;
+  std::vector<Port> m_ports;
+  std::vector<std::vector<uint32_t>> m_portOf;  ///< [ns-3 node id][device ifindex]
+  std::vector<Tree> m_controlTrees;             ///< [source]
+  std::vector<uint32_t> m_subs;
+  std::vector<Delivery> m_delivery;  ///< [sub * kKeys + key]
+  std::unordered_map<uint64_t, std::vector<bool>> m_seen;
+
+  std::array<uint64_t, kKeys> m_published{};
+  std::array<uint64_t, kKeys> m_queueDrops{};
+  uint64_t m_incomplete;
+  uint64_t m_sendFailures;
+  uint64_t m_linkStates;
+  uint64_t m_blocks;
+  uint64_t m_recovers;
+  uint64_t m_pins;
+
+  std::ofstream m_deliveryCsv;
+  std::ofstream m_linksCsv;
+  std::ofstream m_eventsCsv;
+};
+
+}  // namespace ns3
+
+#endif  // ZENOH_SIM_ZENOH_MODEL_H
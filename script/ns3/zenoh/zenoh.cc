@@ -0,0 +1,501 @@
+#include "batched-tap-bridge.h"
+#include "emulated-topology.h"
+#include "flight-recorder.h"
+#include "lag-monitor.h"
+#include "latency-probe.h"
+#include "link-qos.h"
+#include "link-scenario.h"
+#include "link-telemetry.h"
+#include "network-config.h"
+#include "path-observer.h"
+#include "shard-runner.h"
+#include "tap-readiness.h"
+#include "tap-trace.h"
+#include "zenoh-model.h"
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("ZenohEmulation");
+
+namespace {
+
+/// Command line options shared by all shards.
+struct EmulationOptions {
+  std::string mode = "emulate";
+  double stopTime = 600.0;
+  std::string outputDir;
+  std::string tapIo = "batched";
+  uint32_t tapBatch = 64;
+  uint32_t tapPool = 8192;
+  std::string readyFile;
+  bool tapTrace = false;
+  uint32_t tapTraceRingMb = 64;
+  std::string replay;
+  bool lagMonitor = true;
+  double lagThresholdMs = 10.0;
+  std::string lagAction = "flag";
+  double lagReportInterval = 1.0;
+  double telemetryIntervalMs = 0;
+  double pathWindowMs = 0;
+  double pathMinRateKbps = 64;
+  bool latency = false;
+  uint32_t latencyBytes = 64;
+  double latencyHorizon = 30;
+  uint32_t latencyRecords = 16384;
+  std::string latencyIngress;
+  std::string latencyEgress;
+  std::string qos = "off";
+  std::string qosClasses = "sp,4,1";
+  std::string qosMap;
+  std::string qosRate;
+  uint32_t qosBurstKb = 16;
+  uint32_t qosQueueKb = 64;
+  bool recorder = false;
+  double recorderPre = 10;
+  double recorderPost = 5;
+  uint32_t recorderSnaplen = 128;
+  uint32_t recorderMemoryMb = 512;
+  uint32_t recorderQueue = 0;
+  uint32_t recorderDrops = 0;
+  std::string recorderAt;
+  ZenohModelParams model;
+};
+
+/// ns3_output/<experiment>/<YYYYmmdd_HHMMSS>, next to the launcher's experiment_data.
+std::string DefaultOutputDir(const std::string& experiment) {
+  char stamp[32];
+  std::time_t now = std::time(nullptr);
+  std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+  return "ns3_output/" + (experiment.empty() ? std::string("unnamed") : experiment) + "/" + stamp;
+}
+
+/// Non-empty items of a comma separated list.
+std::vector<std::string> SplitList(const std::string& list) {
+  std::vector<std::string> items;
+  std::istringstream is(list);
+  std::string item;
+  while (std::getline(is, item, ',')) {
+    if (!item.empty()) {
+      items.push_back(item);
+    }
+  }
+  return items;
+}
+
+/// Builds the given links, bridges them to their TAPs and runs in real time. With
+/// --mode=replay, TAP traces stand in for the TAPs and the run is as fast as possible.
+int RunEmulation(const NetworkConfig& config,
+                 const EmulationOptions& opt,
+                 LinkScenario* scenario,
+                 const std::vector<uint32_t>& linkIndices,
+                 const std::string& outputDir,
+                 const std::string& readyFile) {
+  bool replay = opt.mode == "replay";
+  bool lagMonitor = opt.lagMonitor && !replay;
+  if (!replay) {
+    GlobalValue::Bind("SimulatorImplementationType", StringValue("ns3::RealtimeSimulatorImpl"));
+  }
+  GlobalValue::Bind("ChecksumEnabled", BooleanValue(true));
+  if (lagMonitor) {
+    LagMonitor::UseLagMonitorScheduler();
+  }
+  SystemPath::MakeDirectories(outputDir);
+
+  EmulatedTopology topology(config);
+  topology.Build(linkIndices);
+  // Before the bridges and observers, which find the device queues at Start.
+  LinkQos qos(topology, outputDir);
+  if (opt.qos != "off") {
+    qos.SetClassifier(opt.qos == "dscp" ? PriorityQueueParams::DSCP : PriorityQueueParams::ZENOH);
+    qos.SetClasses(opt.qosClasses);
+    qos.SetMap(opt.qosMap);
+    qos.SetRates(opt.qosRate);
+    qos.SetBurst(opt.qosBurstKb * 1024);
+    qos.SetQueueLimit(opt.qosQueueKb * 1024);
+    qos.Start();
+  }
+  TapReadiness readiness(topology, outputDir);
+  if (!readyFile.empty()) {
+    readiness.SetReadyFile(readyFile);
+  }
+  Callback<void, uint32_t> attached = MakeCallback(&TapReadiness::Attached, &readiness);
+  BatchedTapBridge taps(topology, outputDir);
+  TapTraceReplay replayer(topology);
+  if (replay) {
+    replayer.Start(SplitList(opt.replay));
+  } else if (opt.tapIo == "batched") {
+    taps.SetBatch(opt.tapBatch);
+    taps.SetPoolFrames(opt.tapPool);
+    taps.SetAttachedCallback(attached);
+    taps.Start();
+  } else {
+    topology.InstallTapBridges(attached);
+  }
+  if (!replay) {
+    readiness.Start();
+  }
+  TapTraceRecorder trace(topology, outputDir + "/tap_trace.bin");
+  if (opt.tapTrace) {
+    trace.SetRingBytes(static_cast<uint64_t>(opt.tapTraceRingMb) << 20);
+    trace.Start();
+  }
+  NS_LOG_UNCOND("experiment " << config.experiment << ": " << config.nodes.size() << " nodes, "
+                              << topology.GetLinks().size() << " links, output in " << outputDir);
+
+  LagMonitor lag(topology, outputDir);
+  if (lagMonitor) {
+    lag.SetThreshold(MicroSeconds(static_cast<uint64_t>(opt.lagThresholdMs * 1000)),
+                     opt.lagAction == "abort");
+    lag.SetReportInterval(Seconds(opt.lagReportInterval));
+    lag.Start();
+    readiness.SetReadyCallback(MakeCallback(&LagMonitor::MeasureFromNow, &lag));
+  }
+  LinkTelemetry telemetry(topology,
+                          outputDir + "/telemetry.bin",
+                          MicroSeconds(static_cast<uint64_t>(opt.telemetryIntervalMs * 1000)));
+  if (opt.telemetryIntervalMs > 0) {
+    telemetry.Start();
+  }
+  PathObserver paths(topology, outputDir);
+  if (opt.pathWindowMs > 0) {
+    paths.SetWindow(MicroSeconds(static_cast<uint64_t>(opt.pathWindowMs * 1000)));
+    paths.SetMinRate(opt.pathMinRateKbps);
+    paths.Start();
+  }
+  LatencyProbe latency(topology, outputDir);
+  if (opt.latency) {
+    latency.SetFingerprintBytes(opt.latencyBytes);
+    latency.SetHorizon(Seconds(opt.latencyHorizon));
+    latency.SetRecords(opt.latencyRecords);
+    latency.SetIngress(SplitList(opt.latencyIngress));
+    latency.SetEgress(SplitList(opt.latencyEgress));
+    latency.Start();
+  }
+  FlightRecorder recorder(topology, outputDir);
+  if (opt.recorder) {
+    recorder.SetWindow(Seconds(opt.recorderPre), Seconds(opt.recorderPost));
+    recorder.SetSnaplen(opt.recorderSnaplen);
+    recorder.SetMemory(static_cast<uint64_t>(opt.recorderMemoryMb) << 20);
+    recorder.SetQueueTrigger(opt.recorderQueue);
+    recorder.SetDropTrigger(opt.recorderDrops, MilliSeconds(100));
+    std::istringstream at(opt.recorderAt);
+    std::string item;
+    while (std::getline(at, item, ',')) {
+      if (!item.empty()) {
+        recorder.ScheduleDump(Seconds(std::stod(item)));
+      }
+    }
+    recorder.Start();
+  }
+  if (scenario) {
+    if (opt.qos != "off") {
+      scenario->SetCapCallback(MakeCallback(&LinkQos::CapChanged, &qos));
+    }
+    scenario->Schedule(topology, outputDir + "/link_events.csv");
+  }
+
+  Simulator::Stop(Seconds(opt.stopTime));
+  auto wallStart = std::chrono::steady_clock::now();
+  Simulator::Run();
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  uint64_t events = Simulator::GetEventCount();
+  NS_LOG_UNCOND("run summary: events=" << events << " wall_s=" << wall
+                                       << " events_per_s=" << (wall > 0 ? events / wall : 0));
+  if (replay) {
+    NS_LOG_UNCOND("replay: " << Simulator::Now().GetSeconds() << " s of traffic, speedup="
+                             << (wall > 0 ? Simulator::Now().GetSeconds() / wall : 0));
+    replayer.Finish();
+  }
+  if (lagMonitor) {
+    lag.Finish();
+  }
+  trace.Stop();
+  telemetry.Stop();
+  if (opt.pathWindowMs > 0) {
+    paths.Finish();
+  }
+  latency.Finish();
+  qos.Finish();
+  recorder.Finish();
+  readiness.Finish();
+  taps.Finish();
+  Simulator::Destroy();
+
+  // Non-zero exit codes let batch scripts reject runs that did not keep up.
+  if (lag.Aborted()) {
+    return 3;
+  }
+  if (lag.Exceeded()) {
+    return 2;
+  }
+  return 0;
+}
+
+/// Runs the links with the in-ns-3 Zenoh model instead of TAPs, as fast as possible.
+int RunSimulation(const NetworkConfig& config,
+                  const EmulationOptions& opt,
+                  LinkScenario* scenario,
+                  const std::string& outputDir) {
+  SystemPath::MakeDirectories(outputDir);
+  EmulatedTopology topology(config);
+  topology.Build();
+  NS_LOG_UNCOND("experiment " << config.experiment << ": " << config.nodes.size() << " nodes, "
+                              << topology.GetLinks().size() << " links, simulated, output in "
+                              << outputDir);
+
+  ZenohModel model(topology, opt.model, outputDir);
+  model.Start();
+  if (scenario) {
+    scenario->Schedule(topology, outputDir + "/link_events.csv");
+  }
+
+  Simulator::Stop(Seconds(opt.stopTime));
+  auto wallStart = std::chrono::steady_clock::now();
+  Simulator::Run();
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  uint64_t events = Simulator::GetEventCount();
+  NS_LOG_UNCOND("run summary: events=" << events << " wall_s=" << wall << " speedup="
+                                       << (wall > 0 ? opt.stopTime / wall : 0));
+  model.Finish();
+  Simulator::Destroy();
+  return 0;
+}
+
+}  // namespace
+
+// Generic emulator for every experiment under script/topology/: the nodes,
+// links and TAP bridges all come from the NETWORK_CONFIG.json5 given with
+// --config, so switching topologies needs no rebuild.
+int main(int argc, char* argv[]) {
+  std::string configPath;
+  std::string linkType;
+  uint32_t shards = 1;
+  std::string shardCpus;
+  std::string scenarioPath;
+  EmulationOptions opt;
+  double simPubInterval = 50;
+  double simSwitchAfter = 30;
+  double simMetricsInterval = 5;
+  double simFlowTtl = 5;
+  double simCleanup = 1;
+  uint32_t simQueueKb = 256;
+
+  CommandLine cmd(__FILE__);
+  cmd.AddValue("config", "Path to the experiment's NETWORK_CONFIG.json5", configPath);
+  cmd.AddValue("mode",
+               "emulate: real time, bridged to the container TAPs; simulate: no TAPs, the "
+               "Zenoh nodes are modelled inside ns-3 and the run is as fast as possible; "
+               "replay: no TAPs, the frames of --replay traces are sent again, as fast as "
+               "possible",
+               opt.mode);
+  cmd.AddValue("stopTime", "Emulation duration in seconds", opt.stopTime);
+  cmd.AddValue("linkType",
+               "Link model for links without their own link_type: csma or p2p "
+               "(overrides the config's top-level link_type)",
+               linkType);
+  cmd.AddValue("scenario",
+               "Scripted link changes (default LINK_SCENARIO.json5 next to the config if it "
+               "exists, none: no changes)",
+               scenarioPath);
+  cmd.AddValue("outputDir",
+               "Directory for emulator output (default ns3_output/<experiment>/<timestamp>)",
+               opt.outputDir);
+  cmd.AddValue("tapIo",
+               "TAP frame I/O: batched (shared I/O threads, all TAPs attached in-process, bursts "
+               "and pooled buffers) or single (one TapBridge and tap-creator per TAP)",
+               opt.tapIo);
+  cmd.AddValue("tapBatch", "batched: frames read from one TAP per wakeup", opt.tapBatch);
+  cmd.AddValue("tapPool", "batched: frame buffers per direction", opt.tapPool);
+  cmd.AddValue("readyFile",
+               "Written once every TAP forwards, removed at the end (default "
+               "<outputDir>/ready.json; with shards, one file per shard with a .<shard> suffix)",
+               opt.readyFile);
+  cmd.AddValue("tapTrace",
+               "Record every frame the TAPs send into their links to tap_trace.bin, for "
+               "--mode=replay",
+               opt.tapTrace);
+  cmd.AddValue("tapTraceRing", "tapTrace: MiB buffered before frames are dropped",
+               opt.tapTraceRingMb);
+  cmd.AddValue("replay", "replay: comma separated tap_trace.bin files to feed into the links",
+               opt.replay);
+  cmd.AddValue("lagMonitor", "Record real-time scheduling lag of every event", opt.lagMonitor);
+  cmd.AddValue("lagThreshold", "Lag in ms above which the run is flagged (0: never)",
+               opt.lagThresholdMs);
+  cmd.AddValue("lagAction", "What to do when lagThreshold is exceeded: flag or abort",
+               opt.lagAction);
+  cmd.AddValue("lagReportInterval", "Seconds between two lines of lag.csv",
+               opt.lagReportInterval);
+  cmd.AddValue("telemetryInterval",
+               "Per-link telemetry sampling interval in ms, written to telemetry.bin (0: off)",
+               opt.telemetryIntervalMs);
+  cmd.AddValue("pathWindow",
+               "Window in ms of the Zenoh path observer, writing path_*.csv (0: off)",
+               opt.pathWindowMs);
+  cmd.AddValue("pathMinRate", "Rate in kbps from which a link counts as carrying a key",
+               opt.pathMinRateKbps);
+  cmd.AddValue("latency",
+               "Measure the one-way latency of every put from pub to sub TAP, writing "
+               "latency_*.csv and latency_summary.json",
+               opt.latency);
+  cmd.AddValue("latencyBytes", "Payload bytes fingerprinted per put (0: all)", opt.latencyBytes);
+  cmd.AddValue("latencyHorizon", "Seconds a put waits for its subscribers", opt.latencyHorizon);
+  cmd.AddValue("latencyRecords", "Puts tracked at the same time", opt.latencyRecords);
+  cmd.AddValue("latencyIngress",
+               "Comma separated TAPs where puts enter (default: link ends of pub nodes)",
+               opt.latencyIngress);
+  cmd.AddValue("latencyEgress",
+               "Comma separated TAPs where puts leave (default: link ends of sub nodes)",
+               opt.latencyEgress);
+  cmd.AddValue("qos",
+               "Egress scheduler of every link end: off (one FIFO), dscp or zenoh (classes "
+               "by IP DSCP or by Zenoh priority, writing qos_classes.csv)",
+               opt.qos);
+  cmd.AddValue("qosClasses",
+               "Comma separated classes, most urgent first: sp (strict priority) or a WDRR "
+               "weight",
+               opt.qosClasses);
+  cmd.AddValue("qosMap",
+               "Comma separated <DSCP or Zenoh priority>=<class> entries over the default "
+               "mapping, e.g. 46=0,34=1",
+               opt.qosMap);
+  cmd.AddValue("qosRate",
+               "Comma separated token bucket rate of every class as a fraction of the link "
+               "cap (0: unlimited)",
+               opt.qosRate);
+  cmd.AddValue("qosBurst", "Token bucket depth in KiB", opt.qosBurstKb);
+  cmd.AddValue("qosQueueKb", "Bytes queued per class and link end in KiB", opt.qosQueueKb);
+  cmd.AddValue("recorder",
+               "Keep recent frames of every link in memory and dump them to recorder/*.pcap "
+               "on triggers (SIGUSR1, recorderAt, recorderQueue, recorderDrops)",
+               opt.recorder);
+  cmd.AddValue("recorderPre", "Seconds of frames kept before a trigger", opt.recorderPre);
+  cmd.AddValue("recorderPost", "Seconds of frames recorded after a trigger", opt.recorderPost);
+  cmd.AddValue("recorderSnaplen", "Bytes kept of every frame", opt.recorderSnaplen);
+  cmd.AddValue("recorderMemory", "MB of ring memory shared by all links", opt.recorderMemoryMb);
+  cmd.AddValue("recorderQueue",
+               "Dump a link when a device queue exceeds this many packets (0: off)",
+               opt.recorderQueue);
+  cmd.AddValue("recorderDrops",
+               "Dump a link on this many drops within 100 ms on one device (0: off)",
+               opt.recorderDrops);
+  cmd.AddValue("recorderAt", "Comma separated simulation seconds at which to dump every link",
+               opt.recorderAt);
+  cmd.AddValue("simPubMbps", "simulate: rate of each data publisher", opt.model.pubMbps);
+  cmd.AddValue("simPubInterval", "simulate: ms between two puts", simPubInterval);
+  cmd.AddValue("simSwitchAfter",
+               "simulate: seconds of publishing after which publisher2 replaces publisher",
+               simSwitchAfter);
+  cmd.AddValue("simRealtimeBytes", "simulate: put size of the RealTime publisher (0: off)",
+               opt.model.realtimeBytes);
+  cmd.AddValue("simMetricsInterval", "simulate: seconds between two congestion checks",
+               simMetricsInterval);
+  cmd.AddValue("simCapBuffer", "simulate: buffer in Mbps subtracted in cap_limit",
+               opt.model.capBufferMbps);
+  cmd.AddValue("simBlockMbps",
+               "simulate: block a link above this data rate instead of cap_limit (0: cap_limit)",
+               opt.model.blockMbps);
+  cmd.AddValue("simRecover", "simulate: recover below this fraction of the block threshold",
+               opt.model.recoverFraction);
+  cmd.AddValue("simFlowTtl", "simulate: seconds after which an idle flow is forgotten",
+               simFlowTtl);
+  cmd.AddValue("simCleanup", "simulate: seconds between two flow table cleanups", simCleanup);
+  cmd.AddValue("simPinning", "simulate: pin active flows when a link gets blocked",
+               opt.model.pinning);
+  cmd.AddValue("simQueueKb", "simulate: data TX queue per link and priority in KiB",
+               simQueueKb);
+  cmd.AddValue("shards",
+               "Split the links over this many emulator processes, one real-time loop each",
+               shards);
+  cmd.AddValue("shardCpus", "Comma separated CPUs to pin shards to (default 0..shards-1)",
+               shardCpus);
+  cmd.Parse(argc, argv);
+
+  NS_ABORT_MSG_IF(configPath.empty(), "usage: zenoh --config=<NETWORK_CONFIG.json5>");
+  NS_ABORT_MSG_IF(opt.lagAction != "flag" && opt.lagAction != "abort",
+                  "--lagAction must be flag or abort");
+  NS_ABORT_MSG_IF(opt.mode != "emulate" && opt.mode != "simulate" && opt.mode != "replay",
+                  "--mode must be emulate, simulate or replay");
+  NS_ABORT_MSG_IF((opt.mode == "replay") == opt.replay.empty(),
+                  "--replay and --mode=replay go together");
+  NS_ABORT_MSG_IF(opt.mode == "replay" && opt.tapTrace, "--tapTrace records TAPs, not replays");
+  NS_ABORT_MSG_IF(opt.tapIo != "single" && opt.tapIo != "batched",
+                  "--tapIo must be single or batched");
+  NS_ABORT_MSG_IF(opt.qos != "off" && opt.qos != "dscp" && opt.qos != "zenoh",
+                  "--qos must be off, dscp or zenoh");
+  NS_ABORT_MSG_IF(opt.qos != "off" && opt.mode == "simulate",
+                  "--qos needs --mode=emulate: the simulated nodes send no IP or Zenoh frames");
+  opt.model.pubInterval = MicroSeconds(static_cast<uint64_t>(simPubInterval * 1000));
+  opt.model.switchAfter = Seconds(simSwitchAfter);
+  opt.model.metricsInterval = MicroSeconds(static_cast<uint64_t>(simMetricsInterval * 1e6));
+  opt.model.flowTtl = MicroSeconds(static_cast<uint64_t>(simFlowTtl * 1e6));
+  opt.model.cleanupInterval = MicroSeconds(static_cast<uint64_t>(simCleanup * 1e6));
+  opt.model.queueBytes = simQueueKb * 1024;
+
+  NetworkConfig config = NetworkConfig::Load(configPath);
+  if (!linkType.empty()) {
+    NetworkConfig::CheckLinkType(linkType, "--linkType");
+    config.defaultLinkType = linkType;
+  }
+  if (opt.outputDir.empty()) {
+    opt.outputDir = DefaultOutputDir(config.experiment);
+  }
+
+  std::unique_ptr<LinkScenario> scenario;
+  if (scenarioPath.empty() && SystemPath::Exists(LinkScenario::DefaultPath(config))) {
+    scenarioPath = LinkScenario::DefaultPath(config);
+  }
+  if (!scenarioPath.empty() && scenarioPath != "none") {
+    scenario = std::make_unique<LinkScenario>(LinkScenario::Load(scenarioPath, config));
+  }
+
+  if (opt.mode == "simulate") {
+    return RunSimulation(config, opt, scenario.get(), opt.outputDir);
+  }
+
+  if (opt.mode == "replay") {
+    // The traces of every shard replay in one process, on the whole topology.
+    std::vector<uint32_t> all(config.links.size());
+    std::iota(all.begin(), all.end(), 0);
+    return RunEmulation(config, opt, scenario.get(), all, opt.outputDir, "");
+  }
+
+  std::vector<std::vector<uint32_t>> plan = ShardRunner::Partition(config, shards);
+  if (plan.size() == 1) {
+    return RunEmulation(config, opt, scenario.get(), plan[0], opt.outputDir, opt.readyFile);
+  }
+
+  // Nothing has touched the simulator yet, so every forked shard starts clean.
+  SystemPath::MakeDirectories(opt.outputDir);
+  std::ofstream os(opt.outputDir + "/shards.csv");
+  os << "shard,link,tap_a,tap_b\n";
+  for (uint32_t s = 0; s < plan.size(); ++s) {
+    for (uint32_t i : plan[s]) {
+      const LinkConfig& link = config.links[i];
+      os << s << "," << link.Name(i) << "," << NetworkConfig::TapName(link.a, link.aIdx) << ","
+         << NetworkConfig::TapName(link.b, link.bIdx) << "\n";
+    }
+  }
+  os.close();
+  NS_LOG_UNCOND("running " << plan.size() << " shards, plan in " << opt.outputDir
+                           << "/shards.csv");
+
+  return ShardRunner::Run(plan.size(), shardCpus, [&](uint32_t shard) {
+    std::ostringstream dir;
+    dir << opt.outputDir << "/shard_" << shard;
+    std::string readyFile;
+    if (!opt.readyFile.empty()) {
+      readyFile = opt.readyFile + "." + std::to_string(shard);
+    }
+    return RunEmulation(config, opt, scenario.get(), plan[shard], dir.str(), readyFile);
+  });
+}
@@ -1,5 +1,32 @@
+#!/bin/bash
+# usage: run_ns3.sh [experiment_name] [emulator args...]
+# Without an experiment name the NETWORK_CONFIG.json5 last handed to the
+# Zenoh launcher is used, so ns-3 and zenohd always see the same links.
+# Once every TAP forwards, ns3_output/ready.json appears (one file per shard,
+# with a .<shard> suffix, under --shards); script/tools/wait_ready.py blocks
+# on it, e.g. before starting publishers.
+
+ROOT_DIR="$(pwd)"
+
+if [ -n "$1" ] && [ "${1#--}" = "$1" ]; then
+    CONFIG="$(pwd)/script/topology/$1/NETWORK_CONFIG.json5"
+    shift
+else
+    CONFIG="$(pwd)/zenohd-auto-deploy/NETWORK_CONFIG.json5"
+fi
+
+if [ ! -f "$CONFIG" ]; then
+    echo "ERROR: $CONFIG not found"
+    exit 1
+fi
+
+mkdir -p "$ROOT_DIR/ns3_output"
+rm -f "$ROOT_DIR"/ns3_output/ready.json*
+
 cd ns-3-dev || exit
 
-    ./ns3 run scratch/zenoh --no-build
+    # Output lands in $ROOT_DIR/ns3_output/<experiment>/<timestamp>/.
+    ./ns3 run "zenoh --config=$CONFIG --readyFile=$ROOT_DIR/ns3_output/ready.json $*" \
+        --cwd="$ROOT_DIR" --no-build
 
-cd -
\ No newline at end of file
+cd -
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""Sweep the parameters of the simulation mode (--mode=simulate) in parallel.
+
+Every combination of the --param values is one run of the emulator binary
+with `--mode=simulate`, in its own output directory under
+<output>/<run name>. When all runs are done, their sim_summary.json files are
+collected into <output>/sweep.csv, one row per run and subscribed key.
+
+    sim_sweep.py twopath --param simCapBuffer=0.5,1,1.5 --param simRecover=0.1,0.2,0.4
+    sim_sweep.py newyork -j 32 --stop 600 --param simFlowTtl=2,5,10 \\
+        --param simCleanup=0.5,1 --param simPinning=true,false
+
+Parameters are passed on as --<name>=<value>, so any emulator option works
+(e.g. --param scenario=foo.json5). The binary is taken from
+ns-3-dev/build/scratch/zenoh/, falling back to `./ns3 run --no-build`.
+"""
+
+import argparse
+import csv
+import glob
+import itertools
+import json
+import os
+import subprocess
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+ROOT_DIR = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+NS3_DIR = os.path.join(ROOT_DIR, "ns-3-dev")
+
+
+def emulator_command():
+    binaries = glob.glob(os.path.join(NS3_DIR, "build", "scratch", "zenoh", "ns3*-zenoh-*"))
+    if binaries:
+        return lambda args: [max(binaries, key=os.path.getmtime)] + args
+    ns3 = os.path.join(NS3_DIR, "ns3")
+    if not os.path.exists(ns3):
+        sys.exit("no ns-3 build in %s, run script/build_ns3.sh first" % NS3_DIR)
+    return lambda args: [ns3, "run", " ".join(["zenoh"] + args), "--no-build"]
+
+
+def parse_params(specs):
+    params = []
+    for spec in specs:
+        name, sep, values = spec.partition("=")
+        if not sep or not values:
+            sys.exit("--param expects name=v1,v2,...: %s" % spec)
+        params.append((name.lstrip("-"), values.split(",")))
+    return params
+
+
+def run_name(point):
+    return "_".join("%s=%s" % (name, value) for name, value in point).replace("/", "-")
+
+
+def run(command, config, stop, out_dir, point):
+    os.makedirs(out_dir, exist_ok=True)
+    args = ["--mode=simulate", "--config=" + config, "--stopTime=%g" % stop,
+            "--outputDir=" + out_dir] + ["--%s=%s" % p for p in point]
+    start = time.time()
+    with open(os.path.join(out_dir, "run.log"), "w") as log:
+        code = subprocess.call(command(args), stdout=log, stderr=subprocess.STDOUT, cwd=NS3_DIR)
+    return code, time.time() - start
+
+
+def summary_rows(out_dir, point, code, wall):
+    base = dict(point)
+    base.update({"exit": code, "wall_s": "%.2f" % wall})
+    try:
+        with open(os.path.join(out_dir, "sim_summary.json")) as f:
+            summary = json.load(f)
+    except (OSError, ValueError):
+        return [base]
+    base.update({name: summary[name] for name in ("blocks", "recovers", "pins")})
+    rows = []
+    for key in summary["keys"]:
+        for sub, stats in sorted(key["subs"].items()):
+            row = dict(base)
+            row.update({"key": key["key"].rsplit("/", 1)[-1], "sub": sub,
+                        "published": key["published"], "queue_drops": key["queue_drops"],
+                        "delivered": stats["delivered"], "loss_pct": stats["loss_pct"]})
+            for stat, value in stats["latency_ms"].items():
+                row["latency_ms_" + stat] = value
+            rows.append(row)
+    return rows or [base]
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("experiment",
+                        help="experiment name under script/topology, or a NETWORK_CONFIG path")
+    parser.add_argument("--param", action="append", default=[], metavar="NAME=V1,V2,...",
+                        help="emulator option and the values to sweep (repeatable)")
+    parser.add_argument("--stop", type=float, default=600, help="simulated seconds (600)")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(),
+                        help="runs in parallel (one per CPU)")
+    parser.add_argument("-o", "--output",
+                        help="output directory (default sim_sweep/<experiment>/<timestamp>)")
+    args = parser.parse_args()
+
+    config = args.experiment
+    if not os.path.isfile(config):
+        config = os.path.join(ROOT_DIR, "script", "topology", config, "NETWORK_CONFIG.json5")
+    if not os.path.isfile(config):
+        sys.exit("%s not found" % config)
+    config = os.path.abspath(config)
+    experiment = os.path.basename(os.path.dirname(config))
+    output = os.path.abspath(args.output or os.path.join(
+        ROOT_DIR, "sim_sweep", experiment, time.strftime("%Y%m%d_%H%M%S")))
+
+    params = parse_params(args.param)
+    points = [list(zip([name for name, _ in params], values))
+              for values in itertools.product(*[values for _, values in params])]
+    command = emulator_command()
+    print("%d runs of %s, %d in parallel, output in %s"
+          % (len(points), experiment, args.jobs, output))
+
+    def job(point):
+        out_dir = os.path.join(output, run_name(point) or "default")
+        code, wall = run(command, config, args.stop, out_dir, point)
+        print("%-60s exit %d  %.1f s" % (run_name(point) or "default", code, wall), flush=True)
+        return summary_rows(out_dir, point, code, wall)
+
+    with ThreadPoolExecutor(max_workers=max(1, args.jobs)) as pool:
+        rows = [row for result in pool.map(job, points) for row in result]
+
+    fields = []
+    for row in rows:
+        fields += [name for name in row if name not in fields]
+    with open(os.path.join(output, "sweep.csv"), "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields)
+        writer.writeheader()
+        writer.writerows(rows)
+    print("wrote %s" % os.path.join(output, "sweep.csv"))
+    return 0 if all(row["exit"] == 0 for row in rows) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
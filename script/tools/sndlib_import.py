@@ -0,0 +1,280 @@
+#!/usr/bin/env python3
+"""Turn an SNDlib network (native .txt or XML) into an experiment.
+
+Writes script/topology/<name>/NETWORK_CONFIG.json5 laid out like the
+hand-made newyork experiment: the SNDlib nodes become routers "0".."N-1" in
+file order, followed by the attached pub and sub nodes. Every link gets its
+own 10.x.y.0/24 subnet, in which node n has the address .n+1 and port
+8000+n. The endpoint index of a node counts its links in link order. Zids are
+derived from the experiment and node names, so re-importing gives the same
+config.
+
+    sndlib_import.py germany50.xml
+    sndlib_import.py ta2.txt --pub N1 --sub N40 --sub N17 --cap 10 --delay geo
+
+Without --pub/--sub one pub is attached to the first node and one sub to the
+node farthest from it in hops.
+"""
+
+import argparse
+import collections
+import hashlib
+import math
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+NUMBER = r"[-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?"
+
+
+def section(text, name):
+    """Body of `NAME ( ... )` in the native format, which nests one level deep."""
+    match = re.search(r"^\s*%s\s*\(" % name, text, re.M)
+    if not match:
+        return ""
+    depth, start = 1, match.end()
+    for i in range(start, len(text)):
+        depth += {"(": 1, ")": -1}.get(text[i], 0)
+        if depth == 0:
+            return text[start:i]
+    sys.exit("unterminated %s section" % name)
+
+
+def parse_native(path):
+    with open(path) as f:
+        text = re.sub(r"#.*", "", f.read())
+    nodes = collections.OrderedDict()
+    for m in re.finditer(r"(\S+)\s*\(\s*(%s)\s+(%s)\s*\)" % (NUMBER, NUMBER),
+                         section(text, "NODES")):
+        nodes[m.group(1)] = (float(m.group(2)), float(m.group(3)))
+    links = []
+    pattern = (r"(\S+)\s*\(\s*(\S+)\s+(\S+)\s*\)\s*(%s)\s+%s\s+%s\s+%s\s*\(([^)]*)\)"
+               % (NUMBER, NUMBER, NUMBER, NUMBER))
+    for m in re.finditer(pattern, section(text, "LINKS")):
+        values = [float(v) for v in m.group(5).split()]
+        links.append({"id": m.group(1), "a": m.group(2), "b": m.group(3),
+                      "preinstalled": float(m.group(4)), "modules": values[0::2]})
+    return nodes, links, None
+
+
+def parse_xml(path):
+    root = ET.parse(path).getroot()
+    for el in root.iter():
+        el.tag = el.tag.split("}")[-1]
+
+    def number(el, tag, default=0.0):
+        child = el.find(tag) if el is not None else None
+        return float(child.text) if child is not None and child.text else default
+
+    structure = root.find("networkStructure")
+    if structure is None:
+        sys.exit("%s: no networkStructure element" % path)
+    nodes = collections.OrderedDict()
+    for node in structure.find("nodes").findall("node"):
+        coords = node.find("coordinates")
+        nodes[node.get("id")] = (number(coords, "x"), number(coords, "y"))
+    links = []
+    for link in structure.find("links").findall("link"):
+        modules = [number(m, "capacity") for m in link.iter("addModule")]
+        links.append({"id": link.get("id"), "a": link.findtext("source").strip(),
+                      "b": link.findtext("target").strip(),
+                      "preinstalled": number(link.find("preInstalledModule"), "capacity"),
+                      "modules": modules})
+    return nodes, links, structure.find("nodes").get("coordinatesType")
+
+
+def great_circle_km(p, q):
+    lon1, lat1, lon2, lat2 = map(math.radians, (p[0], p[1], q[0], q[1]))
+    h = (math.sin((lat2 - lat1) / 2) ** 2 +
+         math.cos(lat1) * math.cos(lat2) * math.sin((lon2 - lon1) / 2) ** 2)
+    return 2 * 6371 * math.asin(math.sqrt(h))
+
+
+def farthest(adjacency, start):
+    """Last node reached by a BFS from start, i.e. one at maximum hop distance."""
+    seen, queue, last = {start}, collections.deque([start]), start
+    while queue:
+        last = queue.popleft()
+        for n in adjacency[last]:
+            if n not in seen:
+                seen.add(n)
+                queue.append(n)
+    if len(seen) < len(adjacency):
+        print("warning: the graph is not connected", file=sys.stderr)
+    return last
+
+
+def link_cap(link, args):
+    if args.cap_from == "preinstalled" and link["preinstalled"] > 0:
+        return link["preinstalled"] * args.cap_scale
+    if args.cap_from == "module" and link["modules"]:
+        return min(link["modules"]) * args.cap_scale
+    return args.cap
+
+
+def fmt(value):
+    return ("%.3f" % value).rstrip("0").rstrip(".")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("path", help="SNDlib network in native (.txt) or XML format")
+    parser.add_argument("-n", "--name", help="experiment name (default: file name)")
+    parser.add_argument("-o", "--output",
+                        help="config to write (default script/topology/<name>/NETWORK_CONFIG.json5)")
+    parser.add_argument("--pub", action="append", default=[],
+                        help="SNDlib node to attach a pub to (repeatable)")
+    parser.add_argument("--sub", action="append", default=[],
+                        help="SNDlib node to attach a sub to (repeatable)")
+    parser.add_argument("--cap", type=float, default=3,
+                        help="cap in Mbps of the SNDlib links (default 3, as in newyork)")
+    parser.add_argument("--cap-from", choices=["fixed", "preinstalled", "module"], default="fixed",
+                        help="take the cap from the pre-installed capacity or the smallest "
+                             "module instead, times --cap-scale; --cap is the fallback")
+    parser.add_argument("--cap-scale", type=float, default=1.0)
+    parser.add_argument("--client-cap", type=float, default=100,
+                        help="cap in Mbps of the pub and sub links")
+    parser.add_argument("--delay", default="",
+                        help="link delay in ms, or 'geo' for great-circle distance at 200 km/ms "
+                             "(default: the emulator's default)")
+    parser.add_argument("--link-type", choices=["csma", "p2p"], help="top-level link_type")
+    parser.add_argument("--keep-parallel", action="store_true",
+                        help="keep several links between the same two nodes (by default only "
+                             "the first is kept, e.g. for directed SNDlib models)")
+    args = parser.parse_args()
+
+    with open(args.path, "rb") as f:
+        is_xml = f.read(256).lstrip().startswith(b"<")
+    nodes, links, coord_type = (parse_xml if is_xml else parse_native)(args.path)
+    if not nodes or not links:
+        sys.exit("%s: no nodes or links found" % args.path)
+    name = args.name or os.path.splitext(os.path.basename(args.path))[0]
+    output = args.output or os.path.join("script", "topology", name, "NETWORK_CONFIG.json5")
+
+    names = list(nodes)
+    index = {n: i for i, n in enumerate(names)}
+    backbone, pairs = [], set()
+    for link in links:
+        for end in (link["a"], link["b"]):
+            if end not in index:
+                sys.exit("%s: link %s uses unknown node %s" % (args.path, link["id"], end))
+        pair = frozenset((link["a"], link["b"]))
+        if len(pair) == 1 or (pair in pairs and not args.keep_parallel):
+            continue
+        pairs.add(pair)
+        backbone.append(link)
+    if len(backbone) < len(links):
+        print("%d self or parallel links skipped" % (len(links) - len(backbone)), file=sys.stderr)
+
+    adjacency = {n: [] for n in names}
+    for link in backbone:
+        adjacency[link["a"]].append(link["b"])
+        adjacency[link["b"]].append(link["a"])
+    pubs = args.pub or [names[0]]
+    subs = args.sub or [farthest(adjacency, pubs[0])]
+    for n in pubs + subs:
+        if n not in index:
+            sys.exit("unknown SNDlib node %s (nodes: %s)" % (n, " ".join(names)))
+
+    if args.delay == "geo":
+        lon_lat = coord_type in (None, "geographical") and all(
+            abs(x) <= 180 and abs(y) <= 90 for x, y in nodes.values())
+        if not lon_lat:
+            sys.exit("%s: --delay geo needs geographical coordinates" % args.path)
+
+    # (a, b, cap, delay, comment) with a and b as emulator node ids.
+    entries = []
+    for i, link in enumerate(backbone):
+        delay = None
+        if args.delay == "geo":
+            delay = great_circle_km(nodes[link["a"]], nodes[link["b"]]) / 200
+        elif args.delay:
+            delay = float(args.delay)
+        comment = "%s <-> %s" % (link["a"], link["b"])
+        if link["id"] != "L%d" % (i + 1):
+            comment += " (SNDlib %s)" % link["id"]
+        entries.append((index[link["a"]], index[link["b"]], link_cap(link, args), delay, comment))
+    clients = [("pub", n) for n in pubs] + [("sub", n) for n in subs]
+    for k, (role, n) in enumerate(clients):
+        entries.append((len(names) + k, index[n], args.client_cap, None,
+                        "%s (node %d) <-> %s (node %d)" % (role, len(names) + k, n, index[n])))
+
+    total = len(names) + len(clients)
+    if total > 254:
+        sys.exit("%d nodes do not fit the .n+1 addressing of a /24" % total)
+    if len(entries) > 255 * 256:
+        sys.exit("too many links")
+
+    # Endpoint indexes in link order, as in the hand-made configs.
+    endpoints = [[] for _ in range(total)]
+    idx = []
+    for number, (a, b, _, _, _) in enumerate(entries, 1):
+        subnet = "10.%d.%d" % (number // 256, number % 256)
+        ends = []
+        for node, peer in ((a, b), (b, a)):
+            peer_name = names[peer] if peer < len(names) else clients[peer - len(names)][0]
+            endpoints[node].append(('"tcp/%s.%d:%d",' % (subnet, node + 1, 8000 + node),
+                                    "L%d to %s" % (number, peer_name)))
+            ends.append(len(endpoints[node]) - 1)
+        idx.append(ends)
+
+    out = []
+    out.append("{")
+    out.append("    // SNDlib %s topology — %d nodes, %d links (imported by sndlib_import.py)"
+               % (name, len(names), len(backbone)))
+    out.append('    experiment: "%s",' % name)
+    if args.link_type:
+        out.append('    link_type: "%s",' % args.link_type)
+    out.append("")
+    out.append("    docker_image: {")
+    out.append('        tag: "eclipse/zenoh:1.4.0",')
+    out.append("        clean_first: false")
+    out.append("    },")
+    out.append("")
+    out.append('    volume: "../zenoh",')
+    out.append("")
+    out.append("    nodes: {")
+    for node in range(total):
+        if node < len(names):
+            out.append("        // Node %d (%s) — %d interfaces" % (node, names[node],
+                                                                  len(endpoints[node])))
+        else:
+            role, attach = clients[node - len(names)]
+            if node == len(names):
+                out.append("        // Added nodes (not from SNDlib)")
+            out.append("        // Node %d — %s, connected to %s (node %d)"
+                       % (node, role, attach, index[attach]))
+        out.append('        "%d": {' % node)
+        if node >= len(names):
+            out.append('            role: "%s",' % clients[node - len(names)][0])
+        zid = hashlib.md5(("%s/%d" % (name, node)).encode()).hexdigest()
+        out.append('            zid: {set: true, value: "%s"},' % zid)
+        out.append("            listen_endpoints: [")
+        for i, (endpoint, comment) in enumerate(endpoints[node]):
+            out.append("                %-24s // %d - %s" % (endpoint, i, comment))
+        out.append("            ],")
+        out.append("        },")
+    out.append("    },")
+    out.append("")
+    out.append("    links: [")
+    for number, ((a, b, cap, delay, comment), (a_idx, b_idx)) in enumerate(zip(entries, idx), 1):
+        if number == len(backbone) + 1:
+            out.append("        // -- added (not from SNDlib) --")
+        out.append("        // L%d: %s" % (number, comment))
+        extra = ", delay: %s" % fmt(delay) if delay is not None else ""
+        out.append('        { a: "%d", a_idx: %d, b: "%d", b_idx: %d, cap: %s%s },'
+                   % (a, a_idx, b, b_idx, fmt(cap), extra))
+    out.append("    ]")
+    out.append("}")
+
+    os.makedirs(os.path.dirname(output) or ".", exist_ok=True)
+    with open(output, "w") as f:
+        f.write("\n".join(out) + "\n")
+    print("%s: %d nodes, %d links, pub at %s, sub at %s"
+          % (output, total, len(entries), " ".join(pubs), " ".join(subs)))
+
+
+if __name__ == "__main__":
+    main()
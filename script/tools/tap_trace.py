@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Summarize an emulator tap_trace.bin (--tapTrace) or convert it to pcap.
+
+Without -w, prints one CSV row per TAP: frames, bytes, first and last frame
+time and the mean rate in between. With -w, writes the frames as an Ethernet
+pcap (FCS removed), optionally only those of some TAPs. The file is mapped,
+not read, so multi-GB traces cost no memory.
+
+    tap_trace.py <tap_trace.bin> [-w out.pcap] [--tap tap_1_0]
+"""
+
+import argparse
+import csv
+import mmap
+import struct
+import sys
+
+TRAILER = 0xFFFFFFFF
+
+
+def read_string(buf, offset):
+    (n,) = struct.unpack_from("<H", buf, offset)
+    return buf[offset + 2:offset + 2 + n].decode(), offset + 2 + n
+
+
+def read_trace(path):
+    """Yields the ends first, then (sim_ns, end, frame) per record."""
+    with open(path, "rb") as f:
+        buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+    magic, version, count, first = struct.unpack_from("<4sIII", buf, 0)
+    if magic != b"ZTRC" or version != 1:
+        sys.exit(f"{path}: not a version 1 TAP trace")
+    ends, offset = [], 16
+    for _ in range(count):
+        index, side, fcs = struct.unpack_from("<IBB", buf, offset)
+        tap, offset = read_string(buf, offset + 6)
+        node, offset = read_string(buf, offset)
+        ends.append({"index": index, "side": side, "fcs": fcs, "tap": tap, "node": node})
+    yield ends
+
+    offset = first
+    while offset + 16 <= len(buf):
+        sim_ns, end, length = struct.unpack_from("<qII", buf, offset)
+        if end == TRAILER:
+            frames, dropped = struct.unpack_from("<QQ", buf, offset + 16)
+            if dropped:
+                print(f"{path}: {dropped} of {frames + dropped} frames were dropped "
+                      "by the emulator", file=sys.stderr)
+            return
+        if end >= count or offset + 16 + length > len(buf):
+            break
+        yield sim_ns, end, buf[offset + 16:offset + 16 + length]
+        offset += (16 + length + 7) & ~7
+    print(f"{path}: no trailer, emulator did not shut down cleanly", file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("path")
+    parser.add_argument("-w", "--pcap", help="write the frames to this pcap file")
+    parser.add_argument("--tap", action="append", help="only this TAP (repeatable)")
+    args = parser.parse_args()
+
+    records = read_trace(args.path)
+    ends = next(records)
+    keep = [args.tap is None or end["tap"] in args.tap for end in ends]
+
+    if args.pcap:
+        with open(args.pcap, "wb") as out:
+            out.write(struct.pack("<IHHiIII", 0xA1B23C4D, 2, 4, 0, 0, 65535, 1))
+            for sim_ns, end, frame in records:
+                if keep[end]:
+                    frame = frame[:len(frame) - ends[end]["fcs"]]
+                    out.write(struct.pack("<IIII", sim_ns // 10**9, sim_ns % 10**9,
+                                          len(frame), len(frame)))
+                    out.write(frame)
+        return
+
+    stats = [[0, 0, None, 0] for _ in ends]
+    for sim_ns, end, frame in records:
+        s = stats[end]
+        s[0] += 1
+        s[1] += len(frame)
+        s[2] = sim_ns if s[2] is None else s[2]
+        s[3] = sim_ns
+    writer = csv.writer(sys.stdout)
+    writer.writerow(["tap", "node", "frames", "bytes", "first_s", "last_s", "mbps"])
+    for end, (frames, size, first, last), wanted in zip(ends, stats, keep):
+        if wanted and frames:
+            span = (last - first) / 1e9
+            writer.writerow([end["tap"], end["node"], frames, size, f"{first / 1e9:.6f}",
+                             f"{last / 1e9:.6f}", f"{size * 8 / span / 1e6:.3f}" if span else ""])
+
+
+if __name__ == "__main__":
+    main()
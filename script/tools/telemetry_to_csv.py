@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""Convert the emulator's telemetry.bin into CSV.
+
+One row per sample and link end. Counters are per sample interval, so
+tx_mbps is the rate over that interval.
+
+    telemetry_to_csv.py <telemetry.bin> [-o out.csv] [--link L3] [--tap tap_1_0]
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+
+def read_string(f):
+    (n,) = struct.unpack("<H", f.read(2))
+    return f.read(n).decode()
+
+
+def read_telemetry(path):
+    """Yields (endpoints, interval_ns) first, then (wall_ns, sim_ns, rows) per sample."""
+    with open(path, "rb") as f:
+        magic, version, count, block_size, interval_ns = struct.unpack("<4sIIIq", f.read(24))
+        if magic != b"ZTEL" or version != 1:
+            sys.exit(f"{path}: not a version 1 telemetry file")
+        endpoints = []
+        for _ in range(count):
+            index, side, cap = struct.unpack("<IBd", f.read(13))
+            endpoints.append({"index": index, "side": side, "cap_mbps": cap,
+                              "link": read_string(f), "tap": read_string(f),
+                              "node": read_string(f)})
+        yield endpoints, interval_ns
+
+        fields = struct.Struct("<" + "I" * 7 * count)
+        while True:
+            block = f.read(block_size)
+            if len(block) < block_size:
+                # Only the 20-byte trailer is shorter than a sample block.
+                if block[:4] == b"ZEND" and len(block) == 20:
+                    written, dropped = struct.unpack_from("<QQ", block, 4)
+                    if dropped:
+                        print(f"{path}: {dropped} of {written + dropped} samples were dropped "
+                              "by the emulator", file=sys.stderr)
+                else:
+                    print(f"{path}: no trailer, emulator did not shut down cleanly",
+                          file=sys.stderr)
+                return
+            wall_ns, sim_ns = struct.unpack_from("<qq", block)
+            values = fields.unpack_from(block, 16)
+            yield wall_ns, sim_ns, [values[i * 7:i * 7 + 7] for i in range(count)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("path")
+    parser.add_argument("-o", "--output", help="CSV file (default stdout)")
+    parser.add_argument("--link", action="append", help="only this link (repeatable)")
+    parser.add_argument("--tap", action="append", help="only this TAP (repeatable)")
+    args = parser.parse_args()
+
+    samples = read_telemetry(args.path)
+    endpoints, interval_ns = next(samples)
+    # Counters cover one interval even when the emulator dropped the samples before.
+    span = interval_ns / 1e9
+    keep = [(args.link is None or ep["link"] in args.link) and
+            (args.tap is None or ep["tap"] in args.tap) for ep in endpoints]
+
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    writer = csv.writer(out)
+    writer.writerow(["wall_time", "sim_s", "link", "tap", "node", "cap_mbps",
+                     "tx_bytes", "tx_frames", "rx_bytes", "rx_frames", "drops",
+                     "q_packets", "q_bytes", "tx_mbps"])
+    for wall_ns, sim_ns, rows in samples:
+        for ep, row, wanted in zip(endpoints, rows, keep):
+            if not wanted:
+                continue
+            tx_mbps = row[0] * 8 / span / 1e6 if span > 0 else 0
+            writer.writerow([f"{wall_ns / 1e9:.6f}", f"{sim_ns / 1e9:.6f}", ep["link"],
+                             ep["tap"], ep["node"], ep["cap_mbps"], *row, f"{tx_mbps:.3f}"])
+    if out is not sys.stdout:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""Block until the emulator forwards on every TAP.
+
+The emulator writes its ready file (--readyFile, by default
+<outputDir>/ready.json) once every TAP is attached and the real-time loop
+runs, and removes it when the run ends. This waits for the file(s) and prints
+when each TAP became ready, so launchers, publishers and benchmarks can start
+right away instead of sleeping.
+
+    wait_ready.py                                    # ns3_output/ready.json (run_ns3.sh)
+    wait_ready.py bench_output/run/ready.json --timeout 30
+    wait_ready.py ns3_output/ready.json --shards 4   # ready.json.0 ... ready.json.3
+    wait_ready.py && z_pub ...
+
+Exits 1 if a file is still missing after --timeout seconds.
+"""
+
+import argparse
+import json
+import os
+import sys
+import time
+
+ROOT_DIR = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+
+
+def load(path):
+    try:
+        with open(path) as f:
+            return json.load(f)
+    except (OSError, ValueError):
+        return None  # not there yet; the emulator renames it into place whole
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("files", nargs="*",
+                        default=[os.path.join(ROOT_DIR, "ns3_output", "ready.json")],
+                        help="ready files to wait for (default ns3_output/ready.json)")
+    parser.add_argument("--shards", type=int, default=0,
+                        help="wait for <file>.0 ... <file>.<shards-1> instead")
+    parser.add_argument("--timeout", type=float, default=120, help="seconds (120)")
+    parser.add_argument("--interval", type=float, default=0.05, help="poll interval (0.05 s)")
+    parser.add_argument("-q", "--quiet", action="store_true", help="only the exit code")
+    args = parser.parse_args()
+
+    files = args.files
+    if args.shards > 0:
+        files = ["%s.%d" % (path, s) for path in files for s in range(args.shards)]
+    start = time.time()
+    pending = list(files)
+    ready = {}
+    while pending:
+        for path in list(pending):
+            doc = load(path)
+            if doc is not None:
+                ready[path] = doc
+                pending.remove(path)
+        if pending and time.time() - start > args.timeout:
+            print("not ready after %g s: %s" % (args.timeout, " ".join(pending)), file=sys.stderr)
+            return 1
+        if pending:
+            time.sleep(args.interval)
+
+    if not args.quiet:
+        for path in files:
+            doc = ready[path]
+            taps = doc["taps"]
+            last = max(taps.items(), key=lambda item: item[1]["attach_ms"])
+            print("%s: %d TAPs, last %s attached after %.1f ms, forwarding after %.1f ms "
+                  "(%.1f s ago)" % (path, len(taps), last[0], last[1]["attach_ms"],
+                                    doc["ready_ms"], time.time() - doc["ready_wall"]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())